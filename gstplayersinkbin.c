@@ -27,46 +27,56 @@
  * |[
  * gst-launch filesrc location="input.ts" ! playersinkbin
  * ]|
+ * Input is typefound: MPEG-TS goes through the TS demuxer, other containers
+ * get their matching demuxer and elementary video/audio streams are handed to
+ * the parser directly.
+ * For instant channel change a "standby_sink" pad can be requested and fed
+ * with the adjacent channel's TS. It is demuxed and parsed/decoded in the
+ * background and the "swap-standby" action signal moves the sinks over to it.
  */
 
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
 #ifdef HAVE_CONFIG_H
 #include <config.h>
 #endif
 
 #include <gst/gst.h>
+#ifdef USE_GST1
+#include <gst/video/video.h>
+#endif
+#ifdef HAVE_GST_MPEGTS
+#include <gst/mpegts/mpegts.h>
+#endif
 
 #include "gstplayersinkbin.h"
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <math.h>
 #include <linux/fb.h>
 #include <fcntl.h>
 #include <sys/ioctl.h>
 #include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/inotify.h>
+#include <sys/mman.h>
+#include <time.h>
 
 #define MULTIPLE_AUDIO_LANG_SELECTION
 #define MEDIA_CONF "/etc/media.conf"
 #define AV_STATUS "/opt/AVstatus.dat"
 #define GST_CAPS "/opt/gstcaps.txt"
+#define LOADAVG "/proc/loadavg"
 /* GST Enums for Plane and Resolution */
-static int OMX_Enable=1;
-static int Audio_Enable=1;
-static int audio_flag=0;
 static int avstatus=0;
 
 #define AUDIO_ENABLE 1
 
-enum VideoParser {
-    MPEG_VPARSE,
-    H264_VPARSE,
-    MAX_VPARSER
-};
-
-const char V_PARSER[MAX_VPARSER][16] = {"mpegvideoparse",\
-                             "h264parse",\
-                            };
-
 GType
 playersink_gst_plane_get_type (void)
 {
@@ -129,6 +139,43 @@ playersink_gst_resolution_get_type (void)
 #define DEFAULT_LIVE 1
 #define DEFAULT_CC_DESC "0"
 
+/* Upper bound for the video GOP kept by a standby input; a GOP larger than
+ * this is dropped and the zap falls back to waiting for the next keyframe */
+#define STANDBY_GOP_CACHE_MAX (4 * 1024 * 1024)
+
+#define DEFAULT_VIDEO_DECODER_THREADS 0
+#define DEFAULT_WATCHDOG_TIMEOUT 0
+#define DEFAULT_ASYNC_EVENTS TRUE
+#define DEFAULT_LOW_POWER FALSE
+#define DEFAULT_LOW_POWER_FRAMERATE 15
+#define DEFAULT_RESOURCE_PRIORITY 0
+#define DEFAULT_AD_PID 0
+/* AD stream silent this long is taken off the mixer */
+#define AD_STALL_TIMEOUT (500 * GST_MSECOND)
+#define DEFAULT_STRETCH_MIN_SPEED 0.5
+#define DEFAULT_STRETCH_MAX_SPEED 2.0
+#define DEFAULT_SUBTITLE_RING_SIZE (256 * 1024)
+/* Area the mosaic is laid out on when "rectangle" is full screen */
+#define MOSAIC_SCREEN_WIDTH 1920
+#define MOSAIC_SCREEN_HEIGHT 1080
+#define WATCHDOG_MAX_ATTEMPTS 3
+#define DEFAULT_TIMESHIFT_DURATION 0
+#define DEFAULT_TIMESHIFT_BITRATE 20000000
+
+#define TS_PACKET_SIZE 188
+#define DEFAULT_INGEST_CHUNK_SIZE 0
+#define DEFAULT_INGEST_LATENCY (10 * GST_MSECOND)
+/* Chunks in use at once: the one filling and the one the demuxer reads */
+#define INGEST_POOL_MIN_BUFFERS 4
+#define DEFAULT_TS_HEALTH_INTERVAL 0
+/* Rate window of the TS health meter when no messages are posted */
+#define TS_HEALTH_WINDOW GST_SECOND
+#define TS_HEALTH_PAT_TIMEOUT (500 * GST_MSECOND)
+#define TS_HEALTH_TICK (TS_HEALTH_PAT_TIMEOUT / 2)
+#define TS_HEALTH_PCR_REPETITION (40 * GST_MSECOND)
+#define TS_HEALTH_PCR_DISCONT (100 * GST_MSECOND)
+#define TS_PCR_WRAP ((G_GUINT64_CONSTANT(1) << 33) * 300)
+
 /* SOC CHANGES: Names of gstreamer Elements to be contained in the bin,add/remove appropriately based on platform */
 #define VIDEO_PLANE	7
 
@@ -146,24 +193,64 @@ playersink_gst_resolution_get_type (void)
 #ifdef USE_GST1
 const char DEMUX[] = "tsdemux";
 const char VDEC[] = "avdec_mpeg2video";
+const char H264_VDEC[] = "avdec_h264";
+const char H265_VDEC[] = "avdec_h265";
 const char AC3_DEC[] = "avdec_ac3";
 const char MP3_DEC[] = "avdec_mp3";
 #else
 const char DEMUX[] = "flutsdemux";
 const char VDEC[] = "ffdec_mpeg2video";
+const char H264_VDEC[] = "ffdec_h264";
+const char H265_VDEC[] = "ffdec_h265";
 const char AC3_DEC[] = "ffdec_ac3";
 const char MP3_DEC[] = "ffdec_mp3";
 #endif
 const char ASINK[] = "autoaudiosink";
 const char VSINK[] = "westerossink";	// Rpi westeros sink
+const char VSINK_FALLBACK[] = "autovideosink";	// software decode path on other machines
 /* End SOC CHANGES */
 
+/* Video codecs handled by playersinkbin: the demuxer caps select the parser
+ * and, when the sink cannot take the elementary stream, the software decoder */
+typedef struct {
+	const char *caps;
+	const char *parser;
+	const char *decoder;
+	const char *conf_key; /* media.conf [decoder] key overriding the decoder */
+} VideoCodec;
+
+static const VideoCodec video_codecs[] = {
+	{ "video/mpeg, mpegversion=(int){ 1, 2 }", "mpegvideoparse", VDEC, "mpeg2" },
+	{ "video/x-h264", "h264parse", H264_VDEC, "h264" },
+	{ "video/x-h265", "h265parse", H265_VDEC, "h265" },
+};
+
+/* Containers demuxed in front of the parsers. System streams are matched here
+ * first since their caps would also match the MPEG video entry above. */
+typedef struct {
+	const char *caps;
+	const char *demux;
+} InputContainer;
+
+static const InputContainer input_containers[] = {
+	{ "video/mpegts", DEMUX },
+	{ "video/mpeg, systemstream=(boolean)true", "mpegpsdemux" },
+	{ "video/quicktime", "qtdemux" },
+	{ "video/x-matroska", "matroskademux" },
+	{ "video/webm", "matroskademux" },
+	{ "video/x-flv", "flvdemux" },
+};
+
 #define GSTPLAYERSINKBIN_EVENT_HAVE_VIDEO 0x01
 #define GSTPLAYERSINKBIN_EVENT_HAVE_AUDIO 0x02
 #define GSTPLAYERSINKBIN_EVENT_FIRST_VIDEO_FRAME 0x03	
 #define GSTPLAYERSINKBIN_EVENT_FIRST_AUDIO_FRAME 0x04
+#define GSTPLAYERSINKBIN_EVENT_VIDEO_RESTARTED 0x05
+#define GSTPLAYERSINKBIN_EVENT_AUDIO_RESTARTED 0x06
 
 static void gst_decode_bin_dispose (GObject * object);
+static void gst_decode_bin_finalize (GObject * object);
+void onDemuxSrcPadAdded(GstElement* element, GstPad *demux_src_pad, gpointer data);
 
 #if defined(ENABLE_AUDIO_REMOVAL_FOR_TRICK_MODES)
 static void createLinkAudioChain (GstPlayerSinkBin *playersinkbin);
@@ -179,6 +266,238 @@ static GstStaticPadTemplate  playersink_bin_sink_template =
                              GST_PAD_ALWAYS,
                              GST_STATIC_CAPS("ANY"));
 
+#ifdef USE_GST1
+/* Input for the standby front-end, fed with the adjacent channel's TS */
+static GstStaticPadTemplate  playersink_bin_standby_template =
+    GST_STATIC_PAD_TEMPLATE ("standby_sink",
+                             GST_PAD_SINK,
+                             GST_PAD_REQUEST,
+                             GST_STATIC_CAPS("ANY"));
+#endif
+
+/* media.conf.
+ * Loaded once per process, when the plugin is registered, and again whenever
+ * the file is written or replaced (inotify on its directory). Each load makes
+ * a new immutable snapshot; instances take a reference at creation and on
+ * READY to PAUSED, so creating one does no file I/O and a tuning change
+ * applies from the next session, thread defaults included unless set as
+ * properties. A key file:
+ *
+ *   [decoder]  omx=true, audio=true, video-threads=<n>,
+ *              mpeg2|h264|h265|ac3|mp3|aac=<element>
+ *   [sink]     video=<element>, audio=<element>
+ *   [queue]    video|audio-max-size-buffers|bytes|time=<n>
+ *   [threads]  demux|video|audio=<same as the *-thread-sched properties>
+ *   [resources] video-decoders=<n, 0 unlimited>, model=platform|local
+ *
+ * The older format, a line holding "OMX" and/or "Audio_Disable", still works.
+ */
+struct _GstPlayerSinkBinMediaConf
+{
+	gint refcount;
+	GKeyFile *keyfile; /* NULL with the older format or no file */
+	gboolean omx;
+	gboolean audio_enable;
+	gint video_decoder_threads; /* -1 when not set */
+	guint video_decoders;       /* decoder slots shared by all instances */
+	gboolean resource_local;    /* stand-in model, software decodes take slots */
+};
+
+static GMutex media_conf_lock;
+static GstPlayerSinkBinMediaConf *media_conf;
+
+static GstPlayerSinkBinMediaConf*
+mediaConfRef (void)
+{
+	GstPlayerSinkBinMediaConf *conf;
+
+	g_mutex_lock(&media_conf_lock);
+	conf = media_conf;
+	g_atomic_int_inc(&conf->refcount);
+	g_mutex_unlock(&media_conf_lock);
+
+	return conf;
+}
+
+static void
+mediaConfUnref (GstPlayerSinkBinMediaConf *conf)
+{
+	if (!conf || !g_atomic_int_dec_and_test(&conf->refcount))
+		return;
+	if (conf->keyfile)
+		g_key_file_free(conf->keyfile);
+	g_free(conf);
+}
+
+static void
+mediaConfLoad (void)
+{
+	GstPlayerSinkBinMediaConf *conf = g_new0(GstPlayerSinkBinMediaConf, 1);
+	GstPlayerSinkBinMediaConf *old;
+	gchar *contents = NULL;
+	gsize length = 0;
+
+	conf->refcount = 1;
+	conf->omx = TRUE;
+	conf->audio_enable = TRUE;
+	conf->video_decoder_threads = -1;
+	conf->video_decoders = 0; /* no arbitration unless configured */
+
+	if (g_file_get_contents(MEDIA_CONF, &contents, &length, NULL))
+	{
+		GKeyFile *keyfile = g_key_file_new();
+
+		if (g_key_file_load_from_data(keyfile, contents, length, G_KEY_FILE_NONE, NULL))
+		{
+			conf->keyfile = keyfile;
+			if (g_key_file_has_key(keyfile, "decoder", "omx", NULL))
+				conf->omx = g_key_file_get_boolean(keyfile, "decoder", "omx", NULL);
+			if (g_key_file_has_key(keyfile, "decoder", "audio", NULL))
+				conf->audio_enable = g_key_file_get_boolean(keyfile, "decoder", "audio", NULL);
+			if (g_key_file_has_key(keyfile, "decoder", "video-threads", NULL))
+				conf->video_decoder_threads = MAX(g_key_file_get_integer(keyfile, "decoder", "video-threads", NULL), 0);
+			if (g_key_file_has_key(keyfile, "resources", "video-decoders", NULL))
+				conf->video_decoders = MAX(g_key_file_get_integer(keyfile, "resources", "video-decoders", NULL), 0);
+			if (g_key_file_has_key(keyfile, "resources", "model", NULL)) {
+				gchar *model = g_key_file_get_string(keyfile, "resources", "model", NULL);
+				conf->resource_local = !g_strcmp0(model, "local");
+				g_free(model);
+			}
+		}
+		else
+		{
+			g_key_file_free(keyfile);
+			if (strstr(contents, "Audio_Disable"))
+				conf->audio_enable = FALSE;
+		}
+		g_free(contents);
+	}
+	GST_INFO("playersinkbin : %s loaded, omx %d audio %d\n", MEDIA_CONF, conf->omx, conf->audio_enable);
+
+	g_mutex_lock(&media_conf_lock);
+	old = media_conf;
+	media_conf = conf;
+	g_mutex_unlock(&media_conf_lock);
+	mediaConfUnref(old);
+}
+
+static gpointer
+mediaConfWatch (gpointer data)
+{
+	gchar *dir = g_path_get_dirname(MEDIA_CONF);
+	gchar *base = g_path_get_basename(MEDIA_CONF);
+	gchar buf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	gint fd = inotify_init1(IN_CLOEXEC);
+	gssize len;
+
+	if (fd < 0 || inotify_add_watch(fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE) < 0)
+	{
+		GST_WARNING("playersinkbin : cannot watch %s, changes need a restart\n", dir);
+		goto done;
+	}
+	while ((len = read(fd, buf, sizeof(buf))) > 0)
+	{
+		gboolean changed = FALSE;
+		gchar *p;
+
+		for (p = buf; p < buf + len; p += sizeof(struct inotify_event) + ((struct inotify_event *) p)->len) {
+			struct inotify_event *event = (struct inotify_event *) p;
+			if (event->len && !strcmp(event->name, base))
+				changed = TRUE;
+		}
+		if (changed)
+			mediaConfLoad();
+	}
+
+done:
+	if (fd >= 0)
+		close(fd);
+	g_free(dir);
+	g_free(base);
+
+	return NULL;
+}
+
+static void
+mediaConfInit (void)
+{
+	mediaConfLoad();
+	g_thread_unref(g_thread_new("playersinkbin-conf", mediaConfWatch, NULL));
+}
+
+/* Snapshot of an instance, swapped under its object lock: streaming threads
+ * keep a reference while they use it */
+static GstPlayerSinkBinMediaConf*
+getMediaConf (GstPlayerSinkBin *playersinkbin)
+{
+	GstPlayerSinkBinMediaConf *conf;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	conf = playersinkbin->conf;
+	g_atomic_int_inc(&conf->refcount);
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	return conf;
+}
+
+/* String value of a key, NULL when not set */
+static gchar*
+mediaConfKey (GstPlayerSinkBinMediaConf *conf, const gchar *group, const gchar *key)
+{
+	if (!conf->keyfile)
+		return NULL;
+
+	return g_key_file_get_string(conf->keyfile, group, key, NULL);
+}
+
+static gchar*
+mediaConfString (GstPlayerSinkBin *playersinkbin, const gchar *group, const gchar *key)
+{
+	GstPlayerSinkBinMediaConf *conf = getMediaConf(playersinkbin);
+	gchar *value = mediaConfKey(conf, group, key);
+
+	mediaConfUnref(conf);
+
+	return value;
+}
+
+/* Element named by a [decoder] or [sink] key, or the built-in choice */
+static GstElement*
+mediaConfMake (GstPlayerSinkBin *playersinkbin, const gchar *group, const gchar *key,
+               const gchar *fallback, const gchar *name)
+{
+	gchar *factory = mediaConfString(playersinkbin, group, key);
+	GstElement *element = gst_element_factory_make(factory ? factory : fallback, name);
+
+	g_free(factory);
+
+	return element;
+}
+
+/* [queue] limits of the video ("video") or audio ("audio") queue */
+static void
+mediaConfQueue (GstPlayerSinkBin *playersinkbin, GstElement *queue, const gchar *stream)
+{
+	static const gchar *limits[] = { "max-size-buffers", "max-size-bytes", "max-size-time" };
+	GstPlayerSinkBinMediaConf *conf = getMediaConf(playersinkbin);
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(limits) && conf->keyfile; i++) {
+		gchar *key = g_strdup_printf("%s-%s", stream, limits[i]);
+
+		if (g_key_file_has_key(conf->keyfile, "queue", key, NULL)) {
+			guint64 value = g_key_file_get_uint64(conf->keyfile, "queue", key, NULL);
+
+			if (i == 2)
+				g_object_set(queue, limits[i], value, NULL);
+			else
+				g_object_set(queue, limits[i], (guint) MIN(value, G_MAXUINT), NULL);
+		}
+		g_free(key);
+	}
+	mediaConfUnref(conf);
+}
+
 /* Properties */
 enum
 {
@@ -199,23 +518,60 @@ enum
 	PROP_VOLUME,
 	PROP_LAST,
 	PROP_IS_LIVE,
-        PROP_CC_DESC
+        PROP_CC_DESC,
+	PROP_ACTIVE_INPUT,
+	PROP_STATS,
+	PROP_INGEST_CHUNK_SIZE,
+	PROP_INGEST_LATENCY,
+	PROP_DEMUX_THREAD_SCHED,
+	PROP_VIDEO_THREAD_SCHED,
+	PROP_AUDIO_THREAD_SCHED,
+	PROP_VIDEO_DECODER_THREADS,
+	PROP_KEYFRAME_INDEX_LOCATION,
+	PROP_TIMESHIFT_DURATION,
+	PROP_TIMESHIFT_BITRATE,
+	PROP_TIMESHIFT_LOCATION,
+	PROP_WATCHDOG_TIMEOUT,
+	PROP_ASYNC_EVENTS,
+	PROP_EVENT_CONTEXT,
+	PROP_LOW_POWER,
+	PROP_LOW_POWER_FRAMERATE,
+	PROP_RESOURCE_PRIORITY,
+	PROP_MOSAIC_PROGRAMS,
+	PROP_AD_PID,
+	PROP_STRETCH_MIN_SPEED,
+	PROP_STRETCH_MAX_SPEED,
+	PROP_DEINTERLACE_METHOD,
+	PROP_SUBTITLE_RING,
+	PROP_SUBTITLE_RING_SIZE,
+	PROP_SCTE35_CUES,
+	PROP_TS_HEALTH_INTERVAL
 };
 
 enum
 {
 	SIGNAL_PLAYERSINKBIN,
+	SIGNAL_SWAP_STANDBY,
+	SIGNAL_GET_KEYFRAME_OFFSET,
+	SIGNAL_SNAPSHOT,
+	SIGNAL_SNAPSHOT_READY,
 	LAST_SIGNAL
 };
 
-static gchar getVideoParserIndex(const gchar* padname) {
-        gchar index = -1;
-        if(g_strrstr(padname, "x-h264"))
-                 index = H264_VPARSE;
-        else if(g_strrstr(padname, "mpeg"))
-                 index = MPEG_VPARSE;
+static const VideoCodec*
+getVideoCodec (GstCaps *caps)
+{
+	const VideoCodec *codec = NULL;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(video_codecs) && !codec; i++) {
+		GstCaps *codec_caps = gst_caps_from_string(video_codecs[i].caps);
+		if (gst_caps_can_intersect(caps, codec_caps))
+			codec = &video_codecs[i];
+		gst_caps_unref(codec_caps);
+	}
 
-        return index;
+	return codec;
 }
 
 static guint gst_player_sinkbin_signals[LAST_SIGNAL] = { 0 };
@@ -226,10 +582,38 @@ static void gst_player_sinkbin_set_property (GObject * object, guint prop_id,
 static void gst_player_sinkbin_get_property (GObject * object, guint prop_id,
         GValue * value, GParamSpec * pspec);
 
-/*static void gst_player_sinkbin_handle_message (GstBin * bin, GstMessage * message);*/
+static void gst_player_sinkbin_handle_message (GstBin * bin, GstMessage * message);
 static GstStateChangeReturn gst_playersinkbin_change_state (GstElement * element,
     GstStateChange transition);
 
+#ifdef USE_GST1
+static GstPad* gst_player_sinkbin_request_new_pad (GstElement * element,
+    GstPadTemplate * templ, const gchar * name, const GstCaps * caps);
+static void gst_player_sinkbin_release_pad (GstElement * element, GstPad * pad);
+static void ingestReset (GstPlayerSinkBinInput *input, gboolean free_pool);
+static void tickStop (GstPlayerSinkBin *playersinkbin, GstClockID *slot, GThread **running);
+static void drainOrphanedChains (GstPlayerSinkBinInput *input);
+static gboolean watchdogHandleError (GstPlayerSinkBin *playersinkbin, GstMessage *message);
+static void watchdogStart (GstPlayerSinkBin *playersinkbin);
+static void watchdogStop (GstPlayerSinkBin *playersinkbin);
+static void watchSink (GstPlayerSinkBin *playersinkbin, GstElement *sink);
+#endif
+static gboolean gst_player_sinkbin_swap_standby (GstPlayerSinkBin * playersinkbin);
+static gint64 gst_player_sinkbin_get_keyframe_offset (GstPlayerSinkBin * playersinkbin,
+    guint64 position, gboolean forward);
+static void keyframeIndexSave (GstPlayerSinkBin *playersinkbin);
+static void configureTimeshift (GstPlayerSinkBin *playersinkbin, GstPlayerSinkBinInput *input);
+static void postEvent (GstPlayerSinkBin *playersinkbin, gint event);
+static gboolean videoSinkScales (GstPlayerSinkBin *playersinkbin);
+static void updateVideoScaling (GstPlayerSinkBin *playersinkbin);
+static void releaseVideoSlot (GstPlayerSinkBin *playersinkbin);
+static void mediaConfDefaults (GstPlayerSinkBin *playersinkbin);
+#ifdef USE_GST1
+static gboolean createMosaic (GstPlayerSinkBinInput *input, GstPad *src_pad);
+static gboolean adStallTick (GstClock *clock, GstClockTime time, GstClockID id, gpointer data);
+#endif
+static guint gst_player_sinkbin_snapshot (GstPlayerSinkBin * playersinkbin, guint width, guint height);
+
 static gboolean printField (GQuark field, const GValue * val, gpointer fp) {
   gchar *str = gst_value_serialize (val);
   
@@ -279,6 +663,118 @@ static void print_pad_caps (GstElement *element, gchar *padName, FILE *fp) {
   gst_object_unref (pad);
 }
 
+/* "event-callback" dispatch.
+ * Events are raised from streaming threads, where a slow handler would hold up
+ * demuxing. They are queued instead, with the time they were raised, and
+ * emitted from the "event-context" main context, or from a dispatch thread of
+ * the bin when the application sets none. An event raised again before the
+ * queue is dispatched is delivered once, in the place it was first raised.
+ */
+typedef struct _PendingEvent
+{
+	gint event;
+	GstClockTime posted;
+	guint count;
+} PendingEvent;
+
+static gpointer
+eventThread (gpointer data)
+{
+	GMainLoop *loop = (GMainLoop *) data;
+
+	g_main_context_push_thread_default(g_main_loop_get_context(loop));
+	g_main_loop_run(loop);
+	g_main_context_pop_thread_default(g_main_loop_get_context(loop));
+
+	return NULL;
+}
+
+static gboolean
+dispatchEvents (gpointer data)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN (data);
+	GQueue events;
+	PendingEvent *pending;
+	GstClockTime delay;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	events = playersinkbin->event_queue;
+	g_queue_init(&playersinkbin->event_queue);
+	playersinkbin->event_source = NULL;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	while ((pending = (PendingEvent *) g_queue_pop_head(&events))) {
+		delay = gst_util_get_timestamp() - pending->posted;
+		GST_OBJECT_LOCK(playersinkbin);
+		playersinkbin->event_delay_last = delay;
+		if (delay > playersinkbin->event_delay_max)
+			playersinkbin->event_delay_max = delay;
+		GST_OBJECT_UNLOCK(playersinkbin);
+		GST_DEBUG_OBJECT(playersinkbin,"playersinkbin : event %d raised %u times, delivered after %" GST_TIME_FORMAT "\n",
+		    pending->event, pending->count, GST_TIME_ARGS(delay));
+		g_signal_emit (G_OBJECT (playersinkbin), gst_player_sinkbin_signals[SIGNAL_PLAYERSINKBIN], 0, pending->event);
+		g_free(pending);
+	}
+
+	return FALSE;
+}
+
+/* Context events go to, starting the dispatch thread if needed. Called with
+ * the object lock held. */
+static GMainContext*
+getEventContext (GstPlayerSinkBin *playersinkbin)
+{
+	if (playersinkbin->event_context)
+		return playersinkbin->event_context;
+
+	if (!playersinkbin->event_loop) {
+		playersinkbin->event_loop = g_main_loop_new(g_main_context_new(), FALSE);
+		g_main_context_unref(g_main_loop_get_context(playersinkbin->event_loop));
+		playersinkbin->event_thread = g_thread_new("playersinkbin-events", eventThread, playersinkbin->event_loop);
+	}
+
+	return g_main_loop_get_context(playersinkbin->event_loop);
+}
+
+static void
+postEvent (GstPlayerSinkBin *playersinkbin, gint event)
+{
+	PendingEvent *pending = NULL;
+	GList *l;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	if (!playersinkbin->async_events) {
+		GST_OBJECT_UNLOCK(playersinkbin);
+		g_signal_emit (G_OBJECT (playersinkbin), gst_player_sinkbin_signals[SIGNAL_PLAYERSINKBIN], 0, event);
+		return;
+	}
+
+	playersinkbin->events_posted++;
+	for (l = playersinkbin->event_queue.head; l && !pending; l = l->next) {
+		if (((PendingEvent *) l->data)->event == event)
+			pending = (PendingEvent *) l->data;
+	}
+	if (pending) {
+		pending->count++;
+		playersinkbin->events_coalesced++;
+	}
+	else {
+		pending = g_new0(PendingEvent, 1);
+		pending->event = event;
+		pending->posted = gst_util_get_timestamp();
+		pending->count = 1;
+		g_queue_push_tail(&playersinkbin->event_queue, pending);
+	}
+
+	if (!playersinkbin->event_source) {
+		playersinkbin->event_source = g_idle_source_new();
+		g_source_set_priority(playersinkbin->event_source, G_PRIORITY_HIGH);
+		g_source_set_callback(playersinkbin->event_source, dispatchEvents, gst_object_ref(playersinkbin), gst_object_unref);
+		g_source_attach(playersinkbin->event_source, getEventContext(playersinkbin));
+		g_source_unref(playersinkbin->event_source);
+	}
+	GST_OBJECT_UNLOCK(playersinkbin);
+}
 
 static GstStateChangeReturn
 gst_playersinkbin_change_state (GstElement * element, GstStateChange transition)
@@ -291,11 +787,27 @@ gst_playersinkbin_change_state (GstElement * element, GstStateChange transition)
     case GST_STATE_CHANGE_NULL_TO_READY:
       break;
     case GST_STATE_CHANGE_READY_TO_PAUSED:
+      {
+        /* Pick up media.conf changes for the new session */
+        GstPlayerSinkBinMediaConf *conf = mediaConfRef();
+        GST_OBJECT_LOCK(playersinkbin);
+        if (conf == playersinkbin->conf) {
+          GST_OBJECT_UNLOCK(playersinkbin);
+          mediaConfUnref(conf);
+        }
+        else {
+          GstPlayerSinkBinMediaConf *old = playersinkbin->conf;
+          playersinkbin->conf = conf;
+          GST_OBJECT_UNLOCK(playersinkbin);
+          mediaConfUnref(old);
+          mediaConfDefaults(playersinkbin);
+        }
+      }
+      configureTimeshift(playersinkbin, &playersinkbin->inputs[0]);
       break;
     case GST_STATE_CHANGE_PAUSED_TO_PLAYING:
        GST_INFO_OBJECT(playersinkbin,"Pipeline in playing state .Emitting GSTPLAYERSINKBIN_EVENT_FIRST_VIDEO_FRAME signal\n");
-        g_signal_emit (G_OBJECT (playersinkbin), gst_player_sinkbin_signals[SIGNAL_PLAYERSINKBIN], 0,
-                                       GSTPLAYERSINKBIN_EVENT_FIRST_VIDEO_FRAME);
+        postEvent (playersinkbin, GSTPLAYERSINKBIN_EVENT_FIRST_VIDEO_FRAME);
 	 FILE *fp;
         fp = fopen(GST_CAPS, "w");
         if(fp == NULL)
@@ -318,6 +830,14 @@ gst_playersinkbin_change_state (GstElement * element, GstStateChange transition)
                 fclose(fq);
                 avstatus=1;
               } 
+#ifdef USE_GST1
+      watchdogStart(playersinkbin);
+#endif
+      break;
+    case GST_STATE_CHANGE_PLAYING_TO_PAUSED:
+#ifdef USE_GST1
+      watchdogStop(playersinkbin);
+#endif
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
       break;
@@ -338,6 +858,17 @@ gst_playersinkbin_change_state (GstElement * element, GstStateChange transition)
                 avstatus=1;
       break;
     case GST_STATE_CHANGE_PAUSED_TO_READY:
+#ifdef USE_GST1
+      {
+        guint i;
+        /* Pads are deactivated, drop whatever ingest batching still holds */
+        tickStop(playersinkbin, &playersinkbin->ingest_tick_id, &playersinkbin->ingest_tick_thread);
+        for (i = 0; i < PLAYERSINKBIN_MAX_INPUTS; i++)
+          ingestReset(&playersinkbin->inputs[i], FALSE);
+      }
+#endif
+      keyframeIndexSave(playersinkbin);
+      releaseVideoSlot(playersinkbin);
       break;
     case GST_STATE_CHANGE_READY_TO_NULL:
                 remove(AV_STATUS);
@@ -364,14 +895,18 @@ gst_player_sinkbin_class_init (GstPlayerSinkBinClass * klass)
 {
 	GObjectClass *gobject_klass;
 	GstElementClass *gstelement_klass;
-	/* GstBinClass *gstbin_klass = (GstBinClass *) klass; */
+	GstBinClass *gstbin_klass = (GstBinClass *) klass;
 
 	gobject_klass = (GObjectClass *) klass;
 	gstelement_klass = (GstElementClass *) klass;
+#ifdef HAVE_GST_MPEGTS
+	gst_mpegts_initialize();
+#endif
 
 	parent_class = g_type_class_peek_parent (klass);
 
 	gobject_klass->dispose = gst_decode_bin_dispose;
+	gobject_klass->finalize = gst_decode_bin_finalize;
 	gobject_klass->set_property = gst_player_sinkbin_set_property;
 	gobject_klass->get_property = gst_player_sinkbin_get_property;
 
@@ -420,7 +955,7 @@ gst_player_sinkbin_class_init (GstPlayerSinkBinClass * klass)
 	                                         G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
 	g_object_class_install_property (gobject_klass, PROP_IS_LIVE,
 	                                 g_param_spec_boolean ("is-live", "is live",
-	                                         "Check whether Live stream or recorded content",
+	                                         "Live stream or recorded content; recorded content is pulled from upstream when it supports random access",
 	                                         DEFAULT_LIVE,
 						 G_PARAM_WRITABLE));
 
@@ -468,9 +1003,178 @@ gst_player_sinkbin_class_init (GstPlayerSinkBinClass * klass)
 	                                         G_MINDOUBLE, G_MAXDOUBLE, DEFAULT_VOLUME,
 	                                         G_PARAM_READWRITE));
 
+	g_object_class_install_property (gobject_klass, PROP_ACTIVE_INPUT,
+	                                 g_param_spec_uint ("active-input", "active-input",
+	                                         "Input feeding the sinks: 0 for the sink pad, 1 for the standby_sink pad",
+	                                         0, PLAYERSINKBIN_MAX_INPUTS - 1, 0,
+	                                         G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_INGEST_CHUNK_SIZE,
+	                                 g_param_spec_uint ("ingest-chunk-size", "ingest-chunk-size",
+	                                         "Coalesce input into chunks of this many bytes, rounded down to whole TS packets (0 = disabled)",
+	                                         0, G_MAXUINT, DEFAULT_INGEST_CHUNK_SIZE,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_INGEST_LATENCY,
+	                                 g_param_spec_uint64 ("ingest-latency", "ingest-latency",
+	                                         "Maximum time in ns coalesced input is held back before it is pushed",
+	                                         0, G_MAXUINT64, DEFAULT_INGEST_LATENCY,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_DEMUX_THREAD_SCHED,
+	                                 g_param_spec_string ("demux-thread-sched", "demux-thread-sched",
+	                                         "Scheduling of the thread running the demuxer as policy[:priority[:cpu-list]], policy one of other/fifo/rr/keep, e.g. \"fifo:40:2-3\"; only when the bin runs it (pull mode or time-shift), never the upstream thread pushing in",
+	                                         NULL,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_VIDEO_THREAD_SCHED,
+	                                 g_param_spec_string ("video-thread-sched", "video-thread-sched",
+	                                         "Scheduling of the video queue thread, same format as demux-thread-sched",
+	                                         NULL,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_AUDIO_THREAD_SCHED,
+	                                 g_param_spec_string ("audio-thread-sched", "audio-thread-sched",
+	                                         "Scheduling of the audio queue thread, same format as demux-thread-sched",
+	                                         NULL,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_VIDEO_DECODER_THREADS,
+	                                 g_param_spec_int ("video-decoder-threads", "video-decoder-threads",
+	                                         "Threads of the software video decoder, 0 sizes them from the idle cores",
+	                                         0, G_MAXINT, DEFAULT_VIDEO_DECODER_THREADS,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_KEYFRAME_INDEX_LOCATION,
+	                                 g_param_spec_string ("keyframe-index-location", "keyframe-index-location",
+	                                         "Sidecar file of the recording's keyframe index, loaded when set and written back on stop",
+	                                         NULL,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_TIMESHIFT_DURATION,
+	                                 g_param_spec_uint64 ("timeshift-duration", "timeshift-duration",
+	                                         "Live pause/rewind buffer in front of the demuxer in ns, 0 disables it (applied on READY to PAUSED)",
+	                                         0, G_MAXUINT64, DEFAULT_TIMESHIFT_DURATION,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_TIMESHIFT_BITRATE,
+	                                 g_param_spec_uint ("timeshift-bitrate", "timeshift-bitrate",
+	                                         "Stream bitrate in bit/s the time-shift buffer is sized for",
+	                                         1, G_MAXUINT, DEFAULT_TIMESHIFT_BITRATE,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_TIMESHIFT_LOCATION,
+	                                 g_param_spec_string ("timeshift-location", "timeshift-location",
+	                                         "Directory of a file-backed time-shift buffer, NULL keeps it in RAM",
+	                                         NULL,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_WATCHDOG_TIMEOUT,
+	                                 g_param_spec_uint64 ("watchdog-timeout", "watchdog-timeout",
+	                                         "Restart an output chain that got no buffer for this long in ns while input kept flowing, or that posted an error; 0 disables it (applied on PAUSED to PLAYING)",
+	                                         0, G_MAXUINT64, DEFAULT_WATCHDOG_TIMEOUT,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_ASYNC_EVENTS,
+	                                 g_param_spec_boolean ("async-events", "async-events",
+	                                         "Queue event-callback emissions to \"event-context\" instead of emitting them from the thread raising them",
+	                                         DEFAULT_ASYNC_EVENTS,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_EVENT_CONTEXT,
+	                                 g_param_spec_pointer ("event-context", "event-context",
+	                                         "GMainContext event-callback is emitted from, NULL uses a dispatch thread of the bin",
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_LOW_POWER,
+	                                 g_param_spec_boolean ("low-power", "low-power",
+	                                         "Secondary (PiP) instance: no audio, and software decode skips B-frames and is capped to \"low-power-framerate\"; MPEG-1/2/4 and MJPEG are also decoded at half size or less (set before PAUSED)",
+	                                         DEFAULT_LOW_POWER,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_LOW_POWER_FRAMERATE,
+	                                 g_param_spec_uint ("low-power-framerate", "low-power-framerate",
+	                                         "Highest output frame rate in low-power mode",
+	                                         1, G_MAXINT, DEFAULT_LOW_POWER_FRAMERATE,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_RESOURCE_PRIORITY,
+	                                 g_param_spec_int ("resource-priority", "resource-priority",
+	                                         "Priority for the decoder slots shared by all instances; a higher one preempts a lower one, which goes on decoding in software",
+	                                         G_MININT, G_MAXINT, DEFAULT_RESOURCE_PRIORITY,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_MOSAIC_PROGRAMS,
+	                                 g_param_spec_string ("mosaic-programs", "mosaic-programs",
+	                                         "Comma separated program numbers of a TS input to show as a grid of tiles in the rectangle, up to 9; NULL plays \"program-num\" alone (applied when the input type is found)",
+	                                         NULL,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_AD_PID,
+	                                 g_param_spec_uint ("ad-pid", "ad-pid",
+	                                         "PID of an audio description track to decode and mix into the main audio, faded and panned as its stream asks; 0 for none (applied when the audio is plugged)",
+	                                         0, 0x1fff, DEFAULT_AD_PID,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_STRETCH_MIN_SPEED,
+	                                 g_param_spec_float ("stretch-min-speed", "stretch-min-speed",
+	                                         "Lowest play speed keeping audio, time-stretched at the original pitch",
+	                                         0.01, 1.0, DEFAULT_STRETCH_MIN_SPEED,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_STRETCH_MAX_SPEED,
+	                                 g_param_spec_float ("stretch-max-speed", "stretch-max-speed",
+	                                         "Highest play speed keeping audio, time-stretched at the original pitch",
+	                                         1.0, 8.0, DEFAULT_STRETCH_MAX_SPEED,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_DEINTERLACE_METHOD,
+	                                 g_param_spec_string ("deinterlace-method", "deinterlace-method",
+	                                         "Method of the deinterlacer put behind the software decoder for interlaced video, a \"method\" of the deinterlace element; NULL chooses by CPU budget",
+	                                         NULL,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_SUBTITLE_RING,
+	                                 g_param_spec_string ("subtitle-ring", "subtitle-ring",
+	                                         "SUBTEC builds: name of a shared memory ring the subtitle PES units are published in, with their PTS, for the renderer to pull (see gstplayersinkbin.h); NULL writes them to the subtecsink file",
+	                                         NULL,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_SUBTITLE_RING_SIZE,
+	                                 g_param_spec_uint ("subtitle-ring-size", "subtitle-ring-size",
+	                                         "Bytes of the subtitle ring, rounded up to a power of two",
+	                                         4096, 64 * 1024 * 1024, DEFAULT_SUBTITLE_RING_SIZE,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_SCTE35_CUES,
+	                                 g_param_spec_boolean ("scte35-cues", "scte35-cues",
+	                                         "Post a \"playersinkbin-scte35\" element message for every SCTE-35 splice cue of a TS input, as soon as the demuxer has it, with its splice point in running time (applied when the input type is found, needs tsdemux 1.20)",
+	                                         FALSE,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_TS_HEALTH_INTERVAL,
+	                                 g_param_spec_uint ("ts-health-interval", "ts-health-interval",
+	                                         "Milliseconds between \"playersinkbin-ts-health\" element messages with the transport stream health of each TS input, also the window of the PID bitrates; 0 posts none, \"stats\" always has the active input's",
+	                                         0, 60000, DEFAULT_TS_HEALTH_INTERVAL,
+	                                         G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS));
+
+	g_object_class_install_property (gobject_klass, PROP_STATS,
+	                                 g_param_spec_boxed ("stats", "stats",
+	                                         "Runtime statistics of the bin as a GstStructure",
+	                                         GST_TYPE_STRUCTURE,
+	                                         G_PARAM_READABLE | G_PARAM_STATIC_STRINGS));
+
 
 	gst_element_class_add_pad_template (gstelement_klass,
 	                                    gst_static_pad_template_get (&playersink_bin_sink_template));
+#ifdef USE_GST1
+	gst_element_class_add_pad_template (gstelement_klass,
+	                                    gst_static_pad_template_get (&playersink_bin_standby_template));
+	gstelement_klass->request_new_pad =
+	    GST_DEBUG_FUNCPTR (gst_player_sinkbin_request_new_pad);
+	gstelement_klass->release_pad =
+	    GST_DEBUG_FUNCPTR (gst_player_sinkbin_release_pad);
+#endif
 
 	gst_element_class_set_details_simple (gstelement_klass,
 	                                      "Player Sink Bin", "Demux/Decoder",
@@ -479,9 +1183,8 @@ gst_player_sinkbin_class_init (GstPlayerSinkBinClass * klass)
 	 gstelement_klass->change_state =
 	     GST_DEBUG_FUNCPTR (gst_playersinkbin_change_state);
 
-	/* gstbin_klass->handle_message =
+	gstbin_klass->handle_message =
 	     GST_DEBUG_FUNCPTR (gst_player_sinkbin_handle_message);
-	*/
 	/**
 	 * Signal that the video/audio has been reached. This signal is emited from
 	 * the onDemuxSrcPadAdded  thread.
@@ -491,6 +1194,54 @@ gst_player_sinkbin_class_init (GstPlayerSinkBinClass * klass)
 	                  (GSignalFlags)(G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION),
 	                  G_STRUCT_OFFSET (GstPlayerSinkBinClass, playersinkbinstatuscb), NULL, NULL,
 	                  g_cclosure_marshal_VOID__INT, G_TYPE_NONE, 1, G_TYPE_INT);
+
+	/**
+	 * Action signal that switches the sinks over to the prerolled standby
+	 * input. Returns FALSE when no standby input with video is available.
+	 */
+	gst_player_sinkbin_signals[SIGNAL_SWAP_STANDBY] =
+	    g_signal_new ("swap-standby", G_TYPE_FROM_CLASS (gstelement_klass),
+	                  (GSignalFlags)(G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION),
+	                  G_STRUCT_OFFSET (GstPlayerSinkBinClass, swap_standby), NULL, NULL,
+	                  g_cclosure_marshal_generic, G_TYPE_BOOLEAN, 0);
+
+	/**
+	 * Action signal looking up the keyframe index of the main input. Returns
+	 * the byte offset of the last keyframe at or before the given stream time,
+	 * or with forward set of the first keyframe after it; -1 when unknown.
+	 */
+	gst_player_sinkbin_signals[SIGNAL_GET_KEYFRAME_OFFSET] =
+	    g_signal_new ("get-keyframe-offset", G_TYPE_FROM_CLASS (gstelement_klass),
+	                  (GSignalFlags)(G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION),
+	                  G_STRUCT_OFFSET (GstPlayerSinkBinClass, get_keyframe_offset), NULL, NULL,
+	                  g_cclosure_marshal_generic, G_TYPE_INT64, 2, G_TYPE_UINT64, G_TYPE_BOOLEAN);
+
+	/**
+	 * Action signal that takes a still of the current service from the last
+	 * picture the video decoder produced, scaled to width x height (0 keeps
+	 * the aspect ratio, both 0 the decoded size). Returns a request id, 0
+	 * when no decoded picture is available, e.g. with decoding sinks.
+	 */
+	gst_player_sinkbin_signals[SIGNAL_SNAPSHOT] =
+	    g_signal_new ("snapshot", G_TYPE_FROM_CLASS (gstelement_klass),
+	                  (GSignalFlags)(G_SIGNAL_RUN_LAST | G_SIGNAL_ACTION),
+	                  G_STRUCT_OFFSET (GstPlayerSinkBinClass, snapshot), NULL, NULL,
+	                  g_cclosure_marshal_generic, G_TYPE_UINT, 2, G_TYPE_UINT, G_TYPE_UINT);
+
+#ifdef USE_GST1
+	/**
+	 * Delivers the GstSample of a "snapshot" request id, NULL when it failed,
+	 * from the "event-context" main context.
+	 */
+	gst_player_sinkbin_signals[SIGNAL_SNAPSHOT_READY] =
+	    g_signal_new ("snapshot-ready", G_TYPE_FROM_CLASS (gstelement_klass),
+	                  G_SIGNAL_RUN_LAST, 0, NULL, NULL,
+	                  g_cclosure_marshal_generic, G_TYPE_NONE, 2, G_TYPE_UINT, GST_TYPE_SAMPLE);
+#endif
+
+	klass->swap_standby = gst_player_sinkbin_swap_standby;
+	klass->get_keyframe_offset = gst_player_sinkbin_get_keyframe_offset;
+	klass->snapshot = gst_player_sinkbin_snapshot;
 }
 
 
@@ -509,7 +1260,7 @@ createLinkAudioChain (
 	}
 
 	/* Create audio decoding pipeline factories */
-	playersinkbin->audio_sink = gst_element_factory_make(ASINK, "player_asink");
+	playersinkbin->audio_sink = mediaConfMake(playersinkbin, "sink", "audio", ASINK, "player_asink");
 
 	if (!playersinkbin->audio_sink) {
 		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate audio decoder (%s)\n", ASINK);
@@ -518,6 +1269,10 @@ createLinkAudioChain (
 
 
 	gst_bin_add_many (GST_BIN(playersinkbin), playersinkbin->audio_sink, NULL);
+#ifdef USE_GST1
+	/* A new sink, the watchdog follows it from its first buffer */
+	watchSink(playersinkbin, playersinkbin->audio_sink);
+#endif
 
 
 	if ((GST_STATE_CHANGE_FAILURE  == gst_element_get_state (GST_ELEMENT (playersinkbin), &gst_current, &gst_pending, timeout * GST_SECOND)) || (gst_current == GST_STATE_NULL) ) {
@@ -528,8 +1283,7 @@ createLinkAudioChain (
                 //send audioCallback event
                 gst_element_sync_state_with_parent(playersinkbin->audio_sink);
                 gst_element_sync_state_with_parent(GST_ELEMENT (playersinkbin));
-                g_signal_emit (G_OBJECT (playersinkbin), gst_player_sinkbin_signals[SIGNAL_PLAYERSINKBIN], 0,
-                                           GSTPLAYERSINKBIN_EVENT_HAVE_AUDIO);
+                postEvent (playersinkbin, GSTPLAYERSINKBIN_EVENT_HAVE_AUDIO);
 
 }
 
@@ -561,250 +1315,5143 @@ deleteUnlinkAudioChain (
         gst_element_unlink(playersinkbin->m_resample,playersinkbin->audio_sink);
         gst_element_sync_state_with_parent(GST_ELEMENT (playersinkbin));
 	playersinkbin->audio_sink = NULL;
+	playersinkbin->audio_teardowns++;
 }
 #endif
 
+/* Play speeds around 1x keep the audio, time-stretched by scaletempo, which
+ * takes the segment rate and keeps the pitch. It goes in between m_aconvert
+ * and m_resample the first time such a speed is set, from an idle probe so
+ * the chain keeps running, and stays there: at 1x it is passthrough. Only
+ * speeds outside the range remove the audio. */
+static gboolean
+speedKeepsAudio (GstPlayerSinkBin *playersinkbin, gfloat speed)
+{
+	return speed == DEFAULT_PLAY_SPEED ||
+	       (speed >= playersinkbin->stretch_min_speed && speed <= playersinkbin->stretch_max_speed);
+}
+
+#ifdef USE_GST1
+static GstPadProbeReturn
+insertTimeStretchProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN(data);
+	GstElement *scaletempo = playersinkbin->m_scaletempo;
+
+	gst_element_unlink(playersinkbin->m_aconvert, playersinkbin->m_resample);
+	gst_bin_add(GST_BIN(playersinkbin), scaletempo);
+	if (!gst_element_link_many(playersinkbin->m_aconvert, scaletempo, playersinkbin->m_resample, NULL))
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to link scaletempo, audio not time-stretched\n");
+		gst_element_unlink_many(playersinkbin->m_aconvert, scaletempo, playersinkbin->m_resample, NULL);
+		gst_bin_remove(GST_BIN(playersinkbin), scaletempo);
+		playersinkbin->m_scaletempo = NULL;
+		gst_element_link(playersinkbin->m_aconvert, playersinkbin->m_resample);
+		return GST_PAD_PROBE_REMOVE;
+	}
+	gst_element_sync_state_with_parent(scaletempo);
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : audio time-stretch inserted\n");
+
+	return GST_PAD_PROBE_REMOVE;
+}
+#endif
 
-/* SOC CHANGES: Dynamic call back from demux element to link audio and video source pads to downstream decode elements
- * For video, identify the video encoder type(h264/mpeg) and link appropriate decoder element if soc has differenti
- * elements for h264 and mpeg.
- * For audio, link the audio pad containing the preferred language if multiple audio language streams are present.
- */
 static void
-plug_pad (GstPlayerSinkBin * playersinkbin, GstPad * demux_src_pad)
+ensureTimeStretch (GstPlayerSinkBin *playersinkbin)
 {
-	GstCaps* caps;
-	const gchar *padname;
-	gchar *pad1;
-         unsigned char index = -1;
 #ifdef USE_GST1
-	caps = gst_pad_get_current_caps(demux_src_pad);
-#else
-	caps =  gst_pad_get_caps(demux_src_pad);
+	GstPad *pad;
+
+	if (playersinkbin->m_scaletempo || !playersinkbin->m_aconvert)
+		return;
+	playersinkbin->m_scaletempo = gst_element_factory_make("scaletempo", "player_scaletempo");
+	if (!playersinkbin->m_scaletempo)
+	{
+		GST_WARNING_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate scaletempo\n");
+		return;
+	}
+	pad = gst_element_get_static_pad(playersinkbin->m_aconvert, "src");
+	gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_IDLE, insertTimeStretchProbe, playersinkbin, NULL);
+	gst_object_unref(pad);
 #endif
-	padname = gst_structure_get_name(gst_caps_get_structure (caps, 0));
-	pad1 = gst_pad_get_name (demux_src_pad);
+}
+
+
+/* Streaming thread scheduling.
+ * Every configurable thread takes a "policy[:priority[:cpu-list]]" string.
+ * Queue threads are configured from their stream-status ENTER message, which
+ * is posted from the new thread itself. Only threads started inside the bin
+ * are touched: in push mode without a time-shift buffer the demuxer runs in
+ * the upstream thread calling into our sink pad, which belongs to the source
+ * and keeps its own scheduling.
+ */
+static gboolean
+parseCpuList (const gchar *str, guint64 *cpus)
+{
+	gchar **ranges = g_strsplit(str, ",", -1);
+	gboolean ret = TRUE;
+	guint i;
+
+	*cpus = 0;
+	for (i = 0; ranges[i] && ret; i++) {
+		gchar *end = NULL;
+		guint64 first = g_ascii_strtoull(ranges[i], &end, 10);
+		guint64 last = first;
+
+		if (end == ranges[i]) {
+			ret = FALSE;
+			break;
+		}
+		if (*end == '-')
+			last = g_ascii_strtoull(end + 1, &end, 10);
+		if (*end != '\0' || last < first || last >= 64) {
+			ret = FALSE;
+			break;
+		}
+		for (; first <= last; first++)
+			*cpus |= G_GUINT64_CONSTANT(1) << first;
+	}
+	g_strfreev(ranges);
+
+	return ret;
+}
+
+static gboolean
+parseThreadSched (const gchar *str, GstPlayerSinkBinThreadConfig *config)
+{
+	gchar **fields;
+	gboolean ret = TRUE;
+	guint n;
+
+	config->policy = -1;
+	config->priority = 0;
+	config->cpus = 0;
+	if (!str || !*str)
+		return TRUE;
+
+	fields = g_strsplit(str, ":", 3);
+	n = g_strv_length(fields);
+	if (!g_ascii_strcasecmp(fields[0], "other"))
+		config->policy = SCHED_OTHER;
+	else if (!g_ascii_strcasecmp(fields[0], "fifo"))
+		config->policy = SCHED_FIFO;
+	else if (!g_ascii_strcasecmp(fields[0], "rr"))
+		config->policy = SCHED_RR;
+	else if (*fields[0] != '\0' && g_ascii_strcasecmp(fields[0], "keep"))
+		ret = FALSE;
+
+	if (ret && n > 1 && *fields[1]) {
+		config->priority = atoi(fields[1]);
+		if (config->policy < 0 ||
+		    config->priority < sched_get_priority_min(config->policy) ||
+		    config->priority > sched_get_priority_max(config->policy))
+			ret = FALSE;
+	}
+	if (ret && n > 2 && *fields[2])
+		ret = parseCpuList(fields[2], &config->cpus);
+	g_strfreev(fields);
+
+	return ret;
+}
+
+static const gchar*
+threadName (GstPlayerSinkBinThread thread)
+{
+	switch (thread) {
+	case PLAYERSINKBIN_THREAD_DEMUX:
+		return "demux";
+	case PLAYERSINKBIN_THREAD_VIDEO:
+		return "video";
+	case PLAYERSINKBIN_THREAD_AUDIO:
+		return "audio";
+	default:
+		return "unknown";
+	}
+}
+
+/* media.conf supplies the defaults of the *-thread-sched and
+ * "video-decoder-threads" properties, re-read with each snapshot taken until
+ * the property is set */
+static void
+mediaConfDefaults (GstPlayerSinkBin *playersinkbin)
+{
+	GstPlayerSinkBinMediaConf *conf = getMediaConf(playersinkbin);
+	gchar *sched[PLAYERSINKBIN_THREAD_MAX];
+	GstPlayerSinkBinThreadConfig config[PLAYERSINKBIN_THREAD_MAX];
+	guint i;
+
+	for (i = 0; i < PLAYERSINKBIN_THREAD_MAX; i++) {
+		sched[i] = mediaConfKey(conf, "threads", threadName(i));
+		if (!parseThreadSched(sched[i], &config[i])) {
+			GST_WARNING_OBJECT(playersinkbin,"playersinkbin : invalid %s thread scheduling \"%s\" in %s\n",
+			                   threadName(i), sched[i], MEDIA_CONF);
+			g_free(sched[i]);
+			sched[i] = NULL;
+			parseThreadSched(NULL, &config[i]);
+		}
+	}
+
+	GST_OBJECT_LOCK(playersinkbin);
+	for (i = 0; i < PLAYERSINKBIN_THREAD_MAX; i++) {
+		if (playersinkbin->thread_sched_set[i])
+			continue;
+		g_free(playersinkbin->thread_sched[i]);
+		playersinkbin->thread_sched[i] = sched[i];
+		playersinkbin->thread_config[i] = config[i];
+		sched[i] = NULL;
+	}
+	if (!playersinkbin->video_decoder_threads_set)
+		playersinkbin->video_decoder_threads = conf->video_decoder_threads >= 0 ?
+		    conf->video_decoder_threads : DEFAULT_VIDEO_DECODER_THREADS;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	for (i = 0; i < PLAYERSINKBIN_THREAD_MAX; i++)
+		g_free(sched[i]);
+	mediaConfUnref(conf);
+}
+
+/* Applies the configuration to the calling thread */
+static void
+applyThreadConfig (GstPlayerSinkBin *playersinkbin, GstPlayerSinkBinThread thread)
+{
+	GstPlayerSinkBinThreadConfig config;
+	int rc;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	config = playersinkbin->thread_config[thread];
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	if (config.policy < 0 && !config.cpus)
+		return;
+	if (config.policy >= 0) {
+		struct sched_param param;
+
+		memset(&param, 0, sizeof(param));
+		param.sched_priority = config.priority;
+		rc = pthread_setschedparam(pthread_self(), config.policy, &param);
+		if (rc)
+			GST_WARNING_OBJECT(playersinkbin,"playersinkbin : cannot set %s thread policy %d priority %d: %s\n",
+			                   threadName(thread), config.policy, config.priority, strerror(rc));
+	}
+	if (config.cpus) {
+		cpu_set_t set;
+		guint cpu;
+
+		CPU_ZERO(&set);
+		for (cpu = 0; cpu < 64; cpu++)
+			if (config.cpus & (G_GUINT64_CONSTANT(1) << cpu))
+				CPU_SET(cpu, &set);
+		rc = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+		if (rc)
+			GST_WARNING_OBJECT(playersinkbin,"playersinkbin : cannot set %s thread affinity: %s\n",
+			                   threadName(thread), strerror(rc));
+	}
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : %s thread configured (policy %d, priority %d, cpus 0x%" G_GINT64_MODIFIER "x)\n",
+	                threadName(thread), config.policy, config.priority, config.cpus);
+}
+
+static gint
+getThreadForElement (GstPlayerSinkBin *playersinkbin, GstElement *element)
+{
+	guint i;
+
+	for (i = 0; i < PLAYERSINKBIN_MAX_INPUTS && element; i++) {
+		GstPlayerSinkBinInput *input = &playersinkbin->inputs[i];
+
+		/* typefind runs the pull loop itself when the demuxer cannot pull, the
+		 * time-shift buffer pushes from its own thread when nothing pulls */
+		if (element == input->demux || element == input->typefind || element == input->timeshift)
+			return PLAYERSINKBIN_THREAD_DEMUX;
+		if (element == input->m_vqueue)
+			return PLAYERSINKBIN_THREAD_VIDEO;
+		if (element == input->m_aqueue)
+			return PLAYERSINKBIN_THREAD_AUDIO;
+	}
+
+	return -1;
+}
+
+static void
+gst_player_sinkbin_handle_message (GstBin * bin, GstMessage * message)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN (bin);
+
+	if (GST_MESSAGE_TYPE(message) == GST_MESSAGE_STREAM_STATUS) {
+		GstStreamStatusType type;
+		GstElement *owner = NULL;
+		gint thread;
+
+		gst_message_parse_stream_status(message, &type, &owner);
+		if (type == GST_STREAM_STATUS_TYPE_ENTER) {
+			thread = getThreadForElement(playersinkbin, owner);
+			if (thread >= 0)
+				applyThreadConfig(playersinkbin, (GstPlayerSinkBinThread) thread);
+		}
+	}
+#ifdef USE_GST1
+	else if (GST_MESSAGE_TYPE(message) == GST_MESSAGE_ERROR && watchdogHandleError(playersinkbin, message)) {
+		gst_message_unref(message);
+		return;
+	}
+#endif
+
+	GST_BIN_CLASS (parent_class)->handle_message (bin, message);
+}
+
+/* Demux front-end handling.
+ * Each input is a sub-bin holding a typefind, the demuxer picked for its input
+ * (none for elementary streams) and the queue/parse(/decode) chains
+ * plugged on its pads. The chains end in "video_src"/"audio_src" ghost pads which
+ * are linked to the shared sinks while the input is active. A standby input keeps
+ * running unlinked behind a gate probe that drops its output and remembers the
+ * last video GOP, so swapping it in costs one relink per sink.
+ */
+static GstPlayerSinkBinInput*
+getInputForPad (GstPlayerSinkBin *playersinkbin, GstPad *demux_src_pad)
+{
+	GstPlayerSinkBinInput *input = NULL;
+	GstElement *demux;
+	guint i;
+
+	demux = gst_pad_get_parent_element(demux_src_pad);
+	for (i = 0; i < PLAYERSINKBIN_MAX_INPUTS && demux; i++) {
+		if (playersinkbin->inputs[i].demux == demux || playersinkbin->inputs[i].typefind == demux) {
+			input = &playersinkbin->inputs[i];
+			break;
+		}
+	}
+	if (demux)
+		gst_object_unref(demux);
+
+	return input;
+}
+
+static void
+updateActiveInput (GstPlayerSinkBin *playersinkbin)
+{
+	GstPlayerSinkBinInput *input = &playersinkbin->inputs[playersinkbin->active_input];
+
+	playersinkbin->demux = input->demux;
+	playersinkbin->m_vqueue = input->m_vqueue;
+	playersinkbin->video_parser = input->video_parser;
+	playersinkbin->video_decoder = input->video_decoder;
+	playersinkbin->m_aqueue = input->m_aqueue;
+	playersinkbin->m_audio_parser = input->m_audio_parser;
+	playersinkbin->m_adec = input->m_adec;
+}
+
+static void
+clearGopCache (GstPlayerSinkBinInput *input)
+{
+	g_list_free_full(input->gop_cache, (GDestroyNotify) gst_buffer_unref);
+	input->gop_cache = NULL;
+	input->gop_cache_bytes = 0;
+}
+
+/* Keyframe index.
+ * While a TS recording plays on the main input, every video buffer leaving the
+ * demuxer is tagged with the input offset the demuxer was reading from, moved
+ * back by the packets the PES took. When the parser flags the buffer as a
+ * keyframe the pair (stream time, offset) goes into the index. Offsets are
+ * rounded down to a packet boundary and err on the early side, the demuxer
+ * resyncs from any packet.
+ * The sidecar file is a header followed by the entries in host byte order,
+ * sorted by time so readers can mmap it and binary search in place.
+ */
+#define KEYFRAME_INDEX_MAGIC "PKFI"
+#define KEYFRAME_INDEX_VERSION 1
+
+typedef struct {
+	gchar magic[4];
+	guint32 version;
+	guint32 entry_size;
+	guint32 reserved;
+	guint64 entries;
+} KeyframeIndexHeader;
+
+/* Index of the first entry later than time, called with the object lock held */
+static guint
+keyframeIndexUpperBound (GstPlayerSinkBin *playersinkbin, guint64 time)
+{
+	GArray *index = playersinkbin->keyframe_index;
+	guint low = 0;
+	guint high = index->len;
+
+	while (low < high) {
+		guint mid = low + (high - low) / 2;
+		if (g_array_index(index, GstPlayerSinkBinIndexEntry, mid).time <= time)
+			low = mid + 1;
+		else
+			high = mid;
+	}
+
+	return low;
+}
+
+static void
+keyframeIndexAdd (GstPlayerSinkBin *playersinkbin, guint64 time, guint64 offset)
+{
+	GstPlayerSinkBinIndexEntry entry;
+	guint pos;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	pos = keyframeIndexUpperBound(playersinkbin, time);
+	if (pos == 0 || g_array_index(playersinkbin->keyframe_index, GstPlayerSinkBinIndexEntry, pos - 1).time != time) {
+		entry.time = time;
+		entry.offset = offset;
+		g_array_insert_val(playersinkbin->keyframe_index, pos, entry);
+		playersinkbin->keyframe_index_dirty = TRUE;
+	}
+	GST_OBJECT_UNLOCK(playersinkbin);
+}
+
+static void
+keyframeIndexLoad (GstPlayerSinkBin *playersinkbin)
+{
+	const KeyframeIndexHeader *header;
+	GMappedFile *file;
+	gsize length;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	g_array_set_size(playersinkbin->keyframe_index, 0);
+	playersinkbin->keyframe_index_dirty = FALSE;
+	file = playersinkbin->keyframe_index_location ?
+	    g_mapped_file_new(playersinkbin->keyframe_index_location, FALSE, NULL) : NULL;
+	GST_OBJECT_UNLOCK(playersinkbin);
+	if (!file)
+		return;
+
+	header = (const KeyframeIndexHeader *) g_mapped_file_get_contents(file);
+	length = g_mapped_file_get_length(file);
+	if (length < sizeof(*header) || memcmp(header->magic, KEYFRAME_INDEX_MAGIC, 4) ||
+	    header->version != KEYFRAME_INDEX_VERSION || header->entry_size != sizeof(GstPlayerSinkBinIndexEntry) ||
+	    header->entries > (length - sizeof(*header)) / sizeof(GstPlayerSinkBinIndexEntry))
+	{
+		GST_WARNING_OBJECT(playersinkbin,"playersinkbin : ignoring invalid keyframe index\n");
+		g_mapped_file_unref(file);
+		return;
+	}
+
+	GST_OBJECT_LOCK(playersinkbin);
+	g_array_append_vals(playersinkbin->keyframe_index, header + 1, header->entries);
+	GST_OBJECT_UNLOCK(playersinkbin);
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : loaded %" G_GUINT64_FORMAT " keyframe index entries\n", header->entries);
+	g_mapped_file_unref(file);
+}
+
+static void
+keyframeIndexSave (GstPlayerSinkBin *playersinkbin)
+{
+	KeyframeIndexHeader *header;
+	gchar *location = NULL;
+	gsize length = 0;
+	GError *error = NULL;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	if (playersinkbin->keyframe_index_location && playersinkbin->keyframe_index_dirty)
+	{
+		GArray *index = playersinkbin->keyframe_index;
+
+		length = sizeof(*header) + index->len * sizeof(GstPlayerSinkBinIndexEntry);
+		header = (KeyframeIndexHeader *) g_malloc0(length);
+		memcpy(header->magic, KEYFRAME_INDEX_MAGIC, 4);
+		header->version = KEYFRAME_INDEX_VERSION;
+		header->entry_size = sizeof(GstPlayerSinkBinIndexEntry);
+		header->entries = index->len;
+		memcpy(header + 1, index->data, index->len * sizeof(GstPlayerSinkBinIndexEntry));
+		location = g_strdup(playersinkbin->keyframe_index_location);
+		playersinkbin->keyframe_index_dirty = FALSE;
+	}
+	GST_OBJECT_UNLOCK(playersinkbin);
+	if (!location)
+		return;
+
+	/* Written to a temporary file and renamed, readers never see a partial index */
+	if (!g_file_set_contents(location, (const gchar *) header, length, &error))
+	{
+		GST_WARNING_OBJECT(playersinkbin,"playersinkbin : failed to write keyframe index %s: %s\n", location, error->message);
+		g_error_free(error);
+	}
+	g_free(header);
+	g_free(location);
+}
+
+static gint64
+gst_player_sinkbin_get_keyframe_offset (GstPlayerSinkBin *playersinkbin, guint64 position, gboolean forward)
+{
+	GArray *index;
+	gint64 offset = -1;
+	guint pos;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	index = playersinkbin->keyframe_index;
+	pos = keyframeIndexUpperBound(playersinkbin, position);
+	if (forward && pos < index->len)
+		offset = g_array_index(index, GstPlayerSinkBinIndexEntry, pos).offset;
+	else if (!forward && pos > 0)
+		offset = g_array_index(index, GstPlayerSinkBinIndexEntry, pos - 1).offset;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	return offset;
+}
+
+/* Index TS recordings played on the main input, once an index file is set */
+static gboolean
+isIndexedInput (GstPlayerSinkBin *playersinkbin, GstPlayerSinkBinInput *input)
+{
+	gboolean indexed;
+
+	if (input != &playersinkbin->inputs[0] || !input->demux ||
+	    strcmp(GST_OBJECT_NAME(gst_element_get_factory(input->demux)), DEMUX))
+		return FALSE;
+	/* Live input cannot be seeked, its index would only grow */
+	GST_OBJECT_LOCK(playersinkbin);
+	indexed = playersinkbin->keyframe_index_location && !playersinkbin->is_live;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	return indexed;
+}
+
+#ifdef USE_GST1
+static GstPadProbeReturn
+indexInputProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+	guint64 back;
+	guint64 offset;
+	guint slot;
+
+	if (!GST_BUFFER_PTS_IS_VALID(buffer))
+		return GST_PAD_PROBE_OK;
+
+	/* The demuxer pushes a PES once the next one starts: step back over the
+	 * packets it took, with some room for adaptation fields */
+	back = ((gst_buffer_get_size(buffer) * 9 / 8) / (TS_PACKET_SIZE - 4) + 2) * TS_PACKET_SIZE;
+	offset = input->in_offset > back ? input->in_offset - back : 0;
+	/* The slots are matched from the parser's thread */
+	GST_OBJECT_LOCK(input->owner);
+	slot = input->index_slot++ % PLAYERSINKBIN_INDEX_PENDING_SLOTS;
+	input->index_pts[slot] = GST_BUFFER_PTS(buffer);
+	input->index_offset[slot] = offset - (offset % TS_PACKET_SIZE);
+	GST_OBJECT_UNLOCK(input->owner);
+
+	return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+indexOutputProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	GstPlayerSinkBin *playersinkbin = input->owner;
+	GstBuffer *buffer;
+	guint64 time = GST_CLOCK_TIME_NONE;
+	guint64 offset = 0;
+	guint i;
+
+	if (info->type & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+		GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+
+		if (GST_EVENT_TYPE(event) == GST_EVENT_SEGMENT) {
+			GST_OBJECT_LOCK(playersinkbin);
+			gst_event_copy_segment(event, &playersinkbin->keyframe_index_segment);
+			GST_OBJECT_UNLOCK(playersinkbin);
+		}
+		return GST_PAD_PROBE_OK;
+	}
+
+	buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+	if (GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT) || !GST_BUFFER_PTS_IS_VALID(buffer))
+		return GST_PAD_PROBE_OK;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	for (i = 0; i < PLAYERSINKBIN_INDEX_PENDING_SLOTS; i++) {
+		if (input->index_pts[i] != GST_BUFFER_PTS(buffer))
+			continue;
+		time = gst_segment_to_stream_time(&playersinkbin->keyframe_index_segment, GST_FORMAT_TIME, GST_BUFFER_PTS(buffer));
+		offset = input->index_offset[i];
+		input->index_pts[i] = GST_CLOCK_TIME_NONE;
+		break;
+	}
+	GST_OBJECT_UNLOCK(playersinkbin);
+	if (GST_CLOCK_TIME_IS_VALID(time))
+		keyframeIndexAdd(playersinkbin, time, offset);
+
+	return GST_PAD_PROBE_OK;
+}
+#endif
+
+#ifdef USE_GST1
+/* Periodic system clock callbacks (watchdog, audio description stall, TS
+ * health) run on the clock's thread and gst_clock_id_unschedule does not wait
+ * for one already running. Each records that it runs, and stopping it waits
+ * for it to return, so nothing it uses goes away under it. */
+static gboolean
+tickEnter (GstPlayerSinkBin *playersinkbin, GstClockID *slot, GstClockID id, GThread **running)
+{
+	GST_OBJECT_LOCK(playersinkbin);
+	if (*slot != id)
+	{
+		GST_OBJECT_UNLOCK(playersinkbin);
+		return FALSE;
+	}
+	*running = g_thread_self();
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	return TRUE;
+}
+
+static void
+tickLeave (GstPlayerSinkBin *playersinkbin, GThread **running)
+{
+	GST_OBJECT_LOCK(playersinkbin);
+	*running = NULL;
+	g_cond_broadcast(&playersinkbin->tick_cond);
+	GST_OBJECT_UNLOCK(playersinkbin);
+}
+
+static void
+tickStop (GstPlayerSinkBin *playersinkbin, GstClockID *slot, GThread **running)
+{
+	GstClockID id;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	id = *slot;
+	*slot = NULL;
+	/* Not when stopped from the callback itself, e.g. by a bus sync handler */
+	while (*running && *running != g_thread_self())
+		g_cond_wait(&playersinkbin->tick_cond, GST_OBJECT_GET_LOCK(playersinkbin));
+	GST_OBJECT_UNLOCK(playersinkbin);
+	if (!id)
+		return;
+	gst_clock_id_unschedule(id);
+	gst_clock_id_unref(id);
+}
+
+/* Transport stream health.
+ * Everything coming into a TS input is metered before it goes further, one
+ * pass over the mapped buffer. Per-PID bytes and continuity need every
+ * packet's header anyway, so packets are walked one by one; the cost per
+ * buffer is kept down by counting into locals and taking the object lock
+ * once. Sync is followed as ETR 290 does: lost after 2 bad sync bytes in a
+ * row, found again after 5 good ones. PCR jitter and the PAT timeout compare
+ * stream time with the arrival of the data, so they are only kept for live
+ * input. A periodic tick on the system clock checks the PAT timeout and
+ * closes intervals in which no data came at all, so an outage is reported.
+ */
+static gboolean tsHealthTick (GstClock *clock, GstClockTime time, GstClockID id, gpointer data);
+
+static void
+tsHealthStart (GstPlayerSinkBinInput *input, GstCaps *caps)
+{
+	GstPlayerSinkBin *playersinkbin = input->owner;
+	GstPlayerSinkBinTsHealth *health = &input->ts_health;
+	GstPlayerSinkBinTsPid *pids = g_new0(GstPlayerSinkBinTsPid, PLAYERSINKBIN_TS_PIDS);
+	gint packetsize = TS_PACKET_SIZE;
+
+	gst_structure_get_int(gst_caps_get_structure(caps, 0), "packetsize", &packetsize);
+	if (packetsize != 192 && packetsize != 204)
+		packetsize = TS_PACKET_SIZE;
+	health->stride = packetsize;
+	health->prefix = (packetsize == 192) ? 4 : 0;
+	health->epoch = 1;
+	health->in_sync = TRUE;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	health->pat_seen = health->interval_start = health->last_arrival = GST_CLOCK_TIME_NONE;
+	health->pids = pids;
+	if (!playersinkbin->ts_health_id)
+	{
+		GstClock *clock = gst_system_clock_obtain();
+
+		playersinkbin->ts_health_id = gst_clock_new_periodic_id(clock, gst_clock_get_time(clock) + TS_HEALTH_TICK,
+		    TS_HEALTH_TICK);
+		gst_clock_id_wait_async(playersinkbin->ts_health_id, tsHealthTick, playersinkbin, NULL);
+		gst_object_unref(clock);
+	}
+	GST_OBJECT_UNLOCK(playersinkbin);
+}
+
+static void
+tsHealthDiscont (GstPlayerSinkBinTsHealth *health)
+{
+	health->epoch = health->epoch == G_MAXUINT8 ? 1 : health->epoch + 1;
+	health->in_sync = TRUE;
+	health->bad_run = health->good_run = 0;
+	health->residual_fill = 0;
+	health->n_pcr = 0;
+}
+
+static void
+tsHealthPcr (GstPlayerSinkBinTsHealth *health, guint pid, const guint8 *p, gboolean discontinuity,
+    GstClockTime arrival, gboolean live, GstPlayerSinkBinTsCounters *counters)
+{
+	guint64 base = ((guint64) p[0] << 25) | (p[1] << 17) | (p[2] << 9) | (p[3] << 1) | (p[4] >> 7);
+	guint64 pcr = base * 300 + (((p[4] & 1) << 8) | p[5]);
+	GstClockTime delta;
+	guint i;
+
+	for (i = 0; i < health->n_pcr && health->pcr[i].pid != pid; i++)
+		;
+	if (i == PLAYERSINKBIN_TS_PCR_PIDS)
+		return;
+	if (i == health->n_pcr)
+	{
+		health->n_pcr++;
+		health->pcr[i].pid = pid;
+		discontinuity = TRUE;
+	}
+
+	delta = (pcr + TS_PCR_WRAP - health->pcr[i].pcr) % TS_PCR_WRAP * 1000 / 27;
+	if (!discontinuity && delta > TS_HEALTH_PCR_DISCONT)
+		counters->pcr_discontinuities++;
+	else if (!discontinuity)
+	{
+		if (delta > TS_HEALTH_PCR_REPETITION)
+			counters->pcr_repetition_errors++;
+		if (live && GST_CLOCK_TIME_IS_VALID(arrival) && GST_CLOCK_TIME_IS_VALID(health->pcr[i].arrival))
+		{
+			GstClockTimeDiff d = GST_CLOCK_DIFF(delta, arrival - health->pcr[i].arrival);
+			GstClockTime jitter = ABS(d);
+
+			/* Smoothed like the RTP interarrival jitter */
+			health->jitter = health->jitter + ((gint64) jitter - (gint64) health->jitter) / 16;
+			if (jitter > health->jitter_max)
+				health->jitter_max = jitter;
+		}
+	}
+	health->pcr[i].pcr = pcr;
+	health->pcr[i].arrival = arrival;
+}
+
+/* Packet whose sync byte is right, p points at it */
+static inline void
+tsHealthPacket (GstPlayerSinkBinTsHealth *health, const guint8 *p, GstClockTime arrival, gboolean live,
+    GstPlayerSinkBinTsCounters *counters)
+{
+	guint pid = ((p[1] & 0x1f) << 8) | p[2];
+	guint afc = (p[3] >> 4) & 3;
+	GstPlayerSinkBinTsPid *entry = &health->pids[pid];
+	gboolean discontinuity;
+
+	entry->bytes += TS_PACKET_SIZE;
+	/* A packet with TEI set has no header to trust */
+	if ((p[1] & 0x80) || pid == 0x1fff)
+		return;
+	if (pid == 0)
+		health->pat_pending = TRUE;
+	discontinuity = (afc & 2) && p[4] && (p[5] & 0x80);
+	if (afc & 1)
+	{
+		guint cc = p[3] & 0x0f;
+
+		/* One duplicate packet is allowed */
+		if (entry->epoch == health->epoch && !discontinuity && cc != entry->cc && cc != ((entry->cc + 1) & 0x0f))
+		{
+			counters->cc_errors++;
+			entry->cc_errors++;
+		}
+		entry->cc = cc;
+		entry->epoch = health->epoch;
+	}
+	if ((afc & 2) && p[4] >= 7 && (p[5] & 0x10))
+		tsHealthPcr(health, pid, p + 6, discontinuity, arrival, live, counters);
+}
+
+/* Packets from pos, returns where they stop */
+static gsize
+tsHealthScan (GstPlayerSinkBinTsHealth *health, const guint8 *data, gsize pos, gsize size,
+    GstClockTime arrival, gboolean live, GstPlayerSinkBinTsCounters *counters)
+{
+	while (pos + health->stride <= size) {
+		const guint8 *p = data + pos + health->prefix;
+
+		if (p[0] != 0x47)
+		{
+			health->good_run = 0;
+			if (health->in_sync)
+			{
+				counters->sync_byte_errors++;
+				if (++health->bad_run < 2)
+				{
+					/* Keep the packet grid over a single bad sync byte */
+					pos += health->stride;
+					continue;
+				}
+				health->in_sync = FALSE;
+				counters->sync_losses++;
+			}
+			pos++;
+			continue;
+		}
+		health->bad_run = 0;
+		if (!health->in_sync && ++health->good_run < 5)
+		{
+			pos += health->stride;
+			continue;
+		}
+		health->in_sync = TRUE;
+		counters->packets++;
+		counters->transport_errors += p[1] >> 7;
+		tsHealthPacket(health, p, arrival, live, counters);
+		pos += health->stride;
+	}
+
+	return pos;
+}
+
+/* Called with the object lock */
+static void
+tsHealthStats (GstPlayerSinkBinTsHealth *health, GstStructure *s)
+{
+	guint i;
+
+	gst_structure_set (s,
+	                   "ts-packets", G_TYPE_UINT64, health->total.packets,
+	                   "ts-sync-losses", G_TYPE_UINT64, health->total.sync_losses,
+	                   "ts-sync-byte-errors", G_TYPE_UINT64, health->total.sync_byte_errors,
+	                   "ts-pat-errors", G_TYPE_UINT64, health->total.pat_errors,
+	                   "ts-cc-errors", G_TYPE_UINT64, health->total.cc_errors,
+	                   "ts-transport-errors", G_TYPE_UINT64, health->total.transport_errors,
+	                   "ts-pcr-repetition-errors", G_TYPE_UINT64, health->total.pcr_repetition_errors,
+	                   "ts-pcr-discontinuities", G_TYPE_UINT64, health->total.pcr_discontinuities,
+	                   "ts-pcr-jitter", G_TYPE_UINT64, health->pcr_jitter,
+	                   "ts-pcr-jitter-max", G_TYPE_UINT64, health->pcr_jitter_max,
+	                   "ts-bitrate", G_TYPE_UINT64, health->bitrate,
+	                   NULL);
+	for (i = 0; i < health->n_rates; i++) {
+		gchar *bitrate = g_strdup_printf("ts-pid-%04x-bitrate", health->rates[i].pid);
+		gchar *cc_errors = g_strdup_printf("ts-pid-%04x-cc-errors", health->rates[i].pid);
+
+		gst_structure_set (s,
+		                   bitrate, G_TYPE_UINT64, health->rates[i].bitrate,
+		                   cc_errors, G_TYPE_UINT, health->rates[i].cc_errors,
+		                   NULL);
+		g_free(bitrate);
+		g_free(cc_errors);
+	}
+}
+
+/* Rates of the interval that ends, then its message */
+static void
+tsHealthInterval (GstPlayerSinkBinInput *input, GstClockTime elapsed, guint interval)
+{
+	GstPlayerSinkBin *playersinkbin = input->owner;
+	GstPlayerSinkBinTsHealth *health = &input->ts_health;
+	GstPlayerSinkBinTsRate rates[PLAYERSINKBIN_TS_RATE_PIDS];
+	guint64 bytes = 0;
+	guint pid;
+	guint n = 0;
+
+	for (pid = 0; pid < PLAYERSINKBIN_TS_PIDS; pid++) {
+		GstPlayerSinkBinTsPid *entry = &health->pids[pid];
+
+		if (!entry->bytes)
+			continue;
+		bytes += entry->bytes;
+		if (n < PLAYERSINKBIN_TS_RATE_PIDS)
+		{
+			rates[n].pid = pid;
+			rates[n].bitrate = gst_util_uint64_scale(entry->bytes * 8, GST_SECOND, elapsed);
+			rates[n].cc_errors = entry->cc_errors;
+			n++;
+		}
+		entry->bytes = 0;
+	}
+
+	GST_OBJECT_LOCK(playersinkbin);
+	memcpy(health->rates, rates, n * sizeof(rates[0]));
+	health->n_rates = n;
+	health->bitrate = gst_util_uint64_scale(bytes * 8, GST_SECOND, elapsed);
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	if (interval)
+	{
+		GstStructure *s = gst_structure_new("playersinkbin-ts-health",
+		        "input", G_TYPE_UINT, (guint) (input - playersinkbin->inputs),
+		        NULL);
+
+		GST_OBJECT_LOCK(playersinkbin);
+		tsHealthStats(health, s);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		gst_element_post_message(GST_ELEMENT(playersinkbin), gst_message_new_element(GST_OBJECT(playersinkbin), s));
+	}
+}
+
+static void
+tsHealthMeter (GstPlayerSinkBinInput *input, GstBuffer *buffer, GstClockTime arrival, gboolean discont)
+{
+	GstPlayerSinkBin *playersinkbin = input->owner;
+	GstPlayerSinkBinTsHealth *health = &input->ts_health;
+	GstPlayerSinkBinTsCounters counters = { 0 };
+	GstClockTime window;
+	GstClockTime elapsed = 0;
+	GstMapInfo map;
+	guint interval;
+	gboolean live;
+	gboolean stalled;
+	gsize pos = 0;
+	gsize n;
+
+	if (!health->pids || !gst_buffer_map(buffer, &map, GST_MAP_READ))
+		return;
+	GST_OBJECT_LOCK(playersinkbin);
+	live = playersinkbin->is_live;
+	interval = playersinkbin->ts_health_interval;
+	stalled = health->stalled;
+	health->stalled = FALSE;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	/* The tick reported the interval these bytes came in */
+	if (stalled)
+	{
+		for (n = 0; n < PLAYERSINKBIN_TS_PIDS; n++)
+			health->pids[n].bytes = 0;
+	}
+	if (discont)
+		tsHealthDiscont(health);
+	if (health->residual_fill)
+	{
+		pos = MIN(health->stride - health->residual_fill, map.size);
+		memcpy(health->residual + health->residual_fill, map.data, pos);
+		health->residual_fill += pos;
+		if (health->residual_fill == health->stride)
+		{
+			tsHealthScan(health, health->residual, 0, health->stride, arrival, live, &counters);
+			health->residual_fill = 0;
+		}
+	}
+
+	pos = tsHealthScan(health, map.data, pos, map.size, arrival, live, &counters);
+	if (health->in_sync && pos < map.size && !health->residual_fill)
+	{
+		health->residual_fill = map.size - pos;
+		memcpy(health->residual, map.data + pos, health->residual_fill);
+	}
+	gst_buffer_unmap(buffer, &map);
+
+	window = interval ? interval * GST_MSECOND : TS_HEALTH_WINDOW;
+	GST_OBJECT_LOCK(playersinkbin);
+	if (health->pat_pending || !GST_CLOCK_TIME_IS_VALID(health->pat_seen))
+		health->pat_seen = arrival;
+	if (health->pat_pending)
+		health->pat_missing = FALSE;
+	health->last_arrival = arrival;
+	health->total.packets += counters.packets;
+	health->total.sync_losses += counters.sync_losses;
+	health->total.sync_byte_errors += counters.sync_byte_errors;
+	health->total.cc_errors += counters.cc_errors;
+	health->total.transport_errors += counters.transport_errors;
+	health->total.pcr_repetition_errors += counters.pcr_repetition_errors;
+	health->total.pcr_discontinuities += counters.pcr_discontinuities;
+	health->pcr_jitter = health->jitter;
+	health->pcr_jitter_max = health->jitter_max;
+	if (!GST_CLOCK_TIME_IS_VALID(health->interval_start))
+		health->interval_start = arrival;
+	else if (arrival - health->interval_start >= window)
+	{
+		elapsed = arrival - health->interval_start;
+		health->interval_start = arrival;
+	}
+	GST_OBJECT_UNLOCK(playersinkbin);
+	health->pat_pending = FALSE;
+
+	if (elapsed)
+		tsHealthInterval(input, elapsed, interval);
+}
+
+/* PAT timeout of live inputs, and intervals a stalled input cannot close */
+static gboolean
+tsHealthTick (GstClock *clock, GstClockTime time, GstClockID id, gpointer data)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN (data);
+	GstClockTime now = gst_util_get_timestamp();
+	GstStructure *messages[PLAYERSINKBIN_MAX_INPUTS] = { NULL };
+	guint i;
+
+	if (!tickEnter(playersinkbin, &playersinkbin->ts_health_id, id, &playersinkbin->ts_health_thread))
+		return TRUE;
+	GST_OBJECT_LOCK(playersinkbin);
+	for (i = 0; i < PLAYERSINKBIN_MAX_INPUTS; i++) {
+		GstPlayerSinkBinTsHealth *health = &playersinkbin->inputs[i].ts_health;
+		guint interval = playersinkbin->ts_health_interval;
+		GstClockTime window = interval ? interval * GST_MSECOND : TS_HEALTH_WINDOW;
+		guint n;
+
+		if (!health->pids || !GST_CLOCK_TIME_IS_VALID(health->last_arrival))
+			continue;
+		if (playersinkbin->is_live && !health->pat_missing && now - health->pat_seen > TS_HEALTH_PAT_TIMEOUT)
+		{
+			health->total.pat_errors++;
+			health->pat_missing = TRUE;
+		}
+		if (now - health->last_arrival < window || now - health->interval_start < window)
+			continue;
+
+		health->interval_start = now;
+		health->stalled = TRUE;
+		health->bitrate = 0;
+		for (n = 0; n < health->n_rates; n++)
+			health->rates[n].bitrate = 0;
+		if (interval)
+		{
+			messages[i] = gst_structure_new("playersinkbin-ts-health", "input", G_TYPE_UINT, i, NULL);
+			tsHealthStats(health, messages[i]);
+		}
+	}
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	for (i = 0; i < PLAYERSINKBIN_MAX_INPUTS; i++) {
+		if (messages[i])
+			gst_element_post_message(GST_ELEMENT(playersinkbin),
+			    gst_message_new_element(GST_OBJECT(playersinkbin), messages[i]));
+	}
+	tickLeave(playersinkbin, &playersinkbin->ts_health_thread);
+
+	return TRUE;
+}
+
+/* Ingest batching.
+ * Upstream pushes a few TS packets per buffer; handing each of those to the
+ * demuxer costs a chain call with its locking. When "ingest-chunk-size" is set
+ * the input is copied into chunks from a recycled buffer pool and each chunk
+ * goes on as one buffer once full. Typefind and the demuxer take buffers only,
+ * so grouping chunks into buffer lists would just have them split again. A
+ * chunk still partly filled "ingest-latency" after its first data came in is
+ * pushed from a tick on the system clock, so a slow or stalled source cannot
+ * hold data back. ingest_first is under the object lock for that tick; the
+ * rest of the state belongs to whoever holds the sink pad's stream lock.
+ */
+typedef struct _IngestFlush
+{
+	GstPlayerSinkBinInput *input;
+	GstPad *pad;
+} IngestFlush;
+
+static gboolean ingestTick (GstClock *clock, GstClockTime time, GstClockID id, gpointer data);
+
+static gboolean
+ingestSetupPool (GstPlayerSinkBinInput *input, guint chunk_size)
+{
+	GstStructure *config;
+
+	if (input->ingest_pool)
+	{
+		gst_buffer_pool_set_active(input->ingest_pool, FALSE);
+		gst_object_unref(input->ingest_pool);
+	}
+	input->ingest_pool = gst_buffer_pool_new();
+	input->ingest_pool_size = 0;
+
+	config = gst_buffer_pool_get_config(input->ingest_pool);
+	gst_buffer_pool_config_set_params(config, NULL, chunk_size, INGEST_POOL_MIN_BUFFERS, 0);
+	if (!gst_buffer_pool_set_config(input->ingest_pool, config) ||
+	    !gst_buffer_pool_set_active(input->ingest_pool, TRUE))
+	{
+		GST_ERROR_OBJECT(input->owner,"playersinkbin : Failed to set up ingest pool of %u byte chunks\n", chunk_size);
+		gst_object_unref(input->ingest_pool);
+		input->ingest_pool = NULL;
+		return FALSE;
+	}
+	input->ingest_pool_size = chunk_size;
+
+	return TRUE;
+}
+
+/* Drop pending data and give the pool back, used on flush and teardown */
+static void
+ingestReset (GstPlayerSinkBinInput *input, gboolean free_pool)
+{
+	if (input->ingest_chunk)
+		gst_buffer_unref(input->ingest_chunk);
+	input->ingest_chunk = NULL;
+	input->ingest_fill = 0;
+	input->ingest_ret = GST_FLOW_OK;
+	GST_OBJECT_LOCK(input->owner);
+	input->ingest_first = GST_CLOCK_TIME_NONE;
+	GST_OBJECT_UNLOCK(input->owner);
+
+	if (free_pool)
+	{
+		if (input->ingest_pool)
+		{
+			gst_buffer_pool_set_active(input->ingest_pool, FALSE);
+			gst_object_unref(input->ingest_pool);
+		}
+		input->ingest_pool = NULL;
+		input->ingest_pool_size = 0;
+	}
+}
+
+/* Push the filled part of the current chunk. Unless draining, a trailing
+ * partial TS packet stays behind in a fresh chunk so pushed data remains
+ * packet aligned. */
+static GstFlowReturn
+ingestPush (GstPlayerSinkBinInput *input, GstPad *pad, GstObject *parent, gboolean drain)
+{
+	GstBuffer *chunk = input->ingest_chunk;
+	gsize aligned;
+	gsize remainder;
+	GstClockTime first;
+	GstFlowReturn ret = GST_FLOW_OK;
+	GstFlowReturn flow;
+
+	if (!chunk)
+		return GST_FLOW_OK;
+	aligned = drain ? input->ingest_fill : input->ingest_fill - (input->ingest_fill % TS_PACKET_SIZE);
+	remainder = input->ingest_fill - aligned;
+	if (aligned == 0)
+	{
+		/* Part of a packet cannot go on alone, its wait starts over */
+		GST_OBJECT_LOCK(input->owner);
+		if (input->ingest_fill)
+			input->ingest_first = gst_util_get_timestamp();
+		GST_OBJECT_UNLOCK(input->owner);
+		return GST_FLOW_OK;
+	}
+
+	input->ingest_chunk = NULL;
+	input->ingest_fill = 0;
+	if (remainder)
+	{
+		GstMapInfo map;
+
+		ret = gst_buffer_pool_acquire_buffer(input->ingest_pool, &input->ingest_chunk, NULL);
+		if (ret == GST_FLOW_OK && gst_buffer_map(chunk, &map, GST_MAP_READ))
+		{
+			gst_buffer_fill(input->ingest_chunk, 0, map.data + aligned, remainder);
+			gst_buffer_unmap(chunk, &map);
+			GST_BUFFER_PTS(input->ingest_chunk) = GST_CLOCK_TIME_NONE;
+			GST_BUFFER_DTS(input->ingest_chunk) = GST_CLOCK_TIME_NONE;
+			GST_BUFFER_OFFSET(input->ingest_chunk) = GST_BUFFER_OFFSET_IS_VALID(chunk) ?
+			    GST_BUFFER_OFFSET(chunk) + aligned : GST_BUFFER_OFFSET_NONE;
+			input->ingest_fill = remainder;
+		}
+	}
+	gst_buffer_set_size(chunk, aligned);
+
+	GST_OBJECT_LOCK(input->owner);
+	first = input->ingest_first;
+	input->ingest_first = input->ingest_fill ? gst_util_get_timestamp() : GST_CLOCK_TIME_NONE;
+	GST_OBJECT_UNLOCK(input->owner);
+
+	if (GST_BUFFER_OFFSET_IS_VALID(chunk))
+		input->in_offset = GST_BUFFER_OFFSET(chunk);
+	/* The oldest data of the chunk came in when it was opened */
+	input->in_arrival = first;
+	input->ingest_chunks++;
+	flow = gst_proxy_pad_chain_default(pad, parent, chunk);
+
+	return ret != GST_FLOW_OK ? ret : flow;
+}
+
+/* Runs at half the latency bound, restarted when the bound changes */
+static void
+ingestStartTick (GstPlayerSinkBin *playersinkbin, GstClockTime latency)
+{
+	GstClockTime period = MAX(latency / 2, GST_MSECOND);
+	GstClock *clock;
+	GstClockID id;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	if (playersinkbin->ingest_tick_id && playersinkbin->ingest_tick_period == period)
+	{
+		GST_OBJECT_UNLOCK(playersinkbin);
+		return;
+	}
+	GST_OBJECT_UNLOCK(playersinkbin);
+	tickStop(playersinkbin, &playersinkbin->ingest_tick_id, &playersinkbin->ingest_tick_thread);
+
+	clock = gst_system_clock_obtain();
+	id = gst_clock_new_periodic_id(clock, gst_clock_get_time(clock) + period, period);
+	gst_object_unref(clock);
+	GST_OBJECT_LOCK(playersinkbin);
+	/* The other input may have been first */
+	if (playersinkbin->ingest_tick_id)
+	{
+		GST_OBJECT_UNLOCK(playersinkbin);
+		gst_clock_id_unref(id);
+		return;
+	}
+	playersinkbin->ingest_tick_id = id;
+	playersinkbin->ingest_tick_period = period;
+	gst_clock_id_wait_async(id, ingestTick, playersinkbin, NULL);
+	GST_OBJECT_UNLOCK(playersinkbin);
+}
+
+static void
+freeIngestFlush (gpointer data)
+{
+	IngestFlush *flush = (IngestFlush *) data;
+
+	gst_object_unref(flush->pad);
+	g_free(flush);
+}
+
+/* Push a chunk that has waited too long, in place of the streaming thread */
+static void
+ingestTimeout (GstElement *element, gpointer data)
+{
+	IngestFlush *flush = (IngestFlush *) data;
+	GstPlayerSinkBinInput *input = flush->input;
+	GstObject *parent;
+	GstFlowReturn ret;
+
+	GST_PAD_STREAM_LOCK(flush->pad);
+	GST_OBJECT_LOCK(input->owner);
+	input->ingest_flush_scheduled = FALSE;
+	GST_OBJECT_UNLOCK(input->owner);
+	/* The input may have been torn down meanwhile */
+	parent = gst_object_get_parent(GST_OBJECT(flush->pad));
+	if (parent && GST_ELEMENT(parent) == input->bin)
+	{
+		ret = ingestPush(input, flush->pad, parent, FALSE);
+		/* Handed back to upstream with the next buffer */
+		if (ret != GST_FLOW_OK && input->ingest_ret == GST_FLOW_OK)
+			input->ingest_ret = ret;
+	}
+	GST_PAD_STREAM_UNLOCK(flush->pad);
+	if (parent)
+		gst_object_unref(parent);
+}
+
+static gboolean
+ingestTick (GstClock *clock, GstClockTime time, GstClockID id, gpointer data)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN (data);
+	GstClockTime now = gst_util_get_timestamp();
+	IngestFlush *flush[PLAYERSINKBIN_MAX_INPUTS] = { NULL };
+	guint i;
+
+	if (!tickEnter(playersinkbin, &playersinkbin->ingest_tick_id, id, &playersinkbin->ingest_tick_thread))
+		return TRUE;
+	GST_OBJECT_LOCK(playersinkbin);
+	for (i = 0; i < PLAYERSINKBIN_MAX_INPUTS; i++) {
+		GstPlayerSinkBinInput *input = &playersinkbin->inputs[i];
+		GstPad *pad;
+
+		if (!input->bin || input->ingest_flush_scheduled || !GST_CLOCK_TIME_IS_VALID(input->ingest_first) ||
+		    now - input->ingest_first < playersinkbin->ingest_latency)
+			continue;
+		pad = gst_element_get_static_pad(input->bin, "sink");
+		if (!pad)
+			continue;
+		input->ingest_flush_scheduled = TRUE;
+		flush[i] = g_new0(IngestFlush, 1);
+		flush[i]->input = input;
+		flush[i]->pad = pad;
+	}
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	/* Not from the clock's thread, the push can block */
+	for (i = 0; i < PLAYERSINKBIN_MAX_INPUTS; i++) {
+		if (flush[i])
+			gst_element_call_async(GST_ELEMENT(playersinkbin), ingestTimeout, flush[i], freeIngestFlush);
+	}
+	tickLeave(playersinkbin, &playersinkbin->ingest_tick_thread);
+
+	return TRUE;
+}
+
+static GstFlowReturn
+ingestBatch (GstPlayerSinkBinInput *input, GstPad *pad, GstObject *parent, GstBuffer *buffer,
+    guint chunk_size, GstClockTime latency)
+{
+	GstClockTime now = gst_util_get_timestamp();
+	gboolean discont = GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DISCONT);
+	GstFlowReturn ret = GST_FLOW_OK;
+	GstMapInfo in;
+	gsize offset = 0;
+
+	/* A push from the tick failed */
+	if (input->ingest_ret != GST_FLOW_OK)
+	{
+		ret = input->ingest_ret;
+		input->ingest_ret = GST_FLOW_OK;
+		gst_buffer_unref(buffer);
+		return ret;
+	}
+	if (chunk_size != input->ingest_pool_size || discont)
+	{
+		ret = ingestPush(input, pad, parent, TRUE);
+		if (chunk_size == 0)
+		{
+			ingestReset(input, TRUE);
+			input->in_offset = GST_BUFFER_OFFSET(buffer);
+			return gst_proxy_pad_chain_default(pad, parent, buffer);
+		}
+		if (ret == GST_FLOW_OK && chunk_size != input->ingest_pool_size && !ingestSetupPool(input, chunk_size))
+			ret = GST_FLOW_ERROR;
+		if (ret != GST_FLOW_OK)
+		{
+			gst_buffer_unref(buffer);
+			return ret;
+		}
+	}
+
+	if (!gst_buffer_map(buffer, &in, GST_MAP_READ))
+	{
+		gst_buffer_unref(buffer);
+		return GST_FLOW_ERROR;
+	}
+	while (offset < in.size)
+	{
+		gsize copy;
+
+		if (!input->ingest_chunk)
+		{
+			ret = gst_buffer_pool_acquire_buffer(input->ingest_pool, &input->ingest_chunk, NULL);
+			if (ret != GST_FLOW_OK)
+				break;
+			input->ingest_fill = 0;
+			GST_BUFFER_PTS(input->ingest_chunk) = offset ? GST_CLOCK_TIME_NONE : GST_BUFFER_PTS(buffer);
+			GST_BUFFER_DTS(input->ingest_chunk) = offset ? GST_CLOCK_TIME_NONE : GST_BUFFER_DTS(buffer);
+			GST_BUFFER_OFFSET(input->ingest_chunk) = GST_BUFFER_OFFSET_IS_VALID(buffer) ?
+			    GST_BUFFER_OFFSET(buffer) + offset : GST_BUFFER_OFFSET_NONE;
+			if (discont && offset == 0)
+				GST_BUFFER_FLAG_SET(input->ingest_chunk, GST_BUFFER_FLAG_DISCONT);
+		}
+		if (input->ingest_fill == 0)
+		{
+			GST_OBJECT_LOCK(input->owner);
+			input->ingest_first = now;
+			GST_OBJECT_UNLOCK(input->owner);
+		}
+
+		copy = MIN(in.size - offset, chunk_size - input->ingest_fill);
+		gst_buffer_fill(input->ingest_chunk, input->ingest_fill, in.data + offset, copy);
+		input->ingest_fill += copy;
+		offset += copy;
+
+		if (input->ingest_fill == chunk_size)
+			ret = ingestPush(input, pad, parent, TRUE);
+		if (ret != GST_FLOW_OK)
+			break;
+	}
+	gst_buffer_unmap(buffer, &in);
+	gst_buffer_unref(buffer);
+
+	if (ret != GST_FLOW_OK || !input->ingest_chunk)
+		return ret;
+	if (now - input->ingest_first >= latency)
+		return ingestPush(input, pad, parent, FALSE);
+	ingestStartTick(input->owner, latency);
+
+	return ret;
+}
+
+static GstFlowReturn
+inputSinkChain (GstPad *pad, GstObject *parent, GstBuffer *buffer)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) gst_pad_get_element_private(pad);
+	GstClockTime start = gst_util_get_timestamp();
+	gsize size = gst_buffer_get_size(buffer);
+	guint chunk_size;
+	GstClockTime latency;
+	GstFlowReturn ret;
+
+	input->in_arrival = start;
+
+	GST_OBJECT_LOCK(input->owner);
+	chunk_size = input->owner->ingest_chunk_size;
+	latency = input->owner->ingest_latency;
+	GST_OBJECT_UNLOCK(input->owner);
+
+	tsHealthMeter(input, buffer, start, GST_BUFFER_IS_DISCONT(buffer));
+
+	/* Sources without offsets get the running byte count for the keyframe index */
+	if (!GST_BUFFER_OFFSET_IS_VALID(buffer) && isIndexedInput(input->owner, input))
+	{
+		buffer = gst_buffer_make_writable(buffer);
+		GST_BUFFER_OFFSET(buffer) = input->in_bytes;
+	}
+
+	if (chunk_size == 0 && input->ingest_pool_size == 0)
+	{
+		input->in_offset = GST_BUFFER_OFFSET(buffer);
+		ret = gst_proxy_pad_chain_default(pad, parent, buffer);
+	}
+	else
+		ret = ingestBatch(input, pad, parent, buffer, chunk_size, latency);
+
+	GST_OBJECT_LOCK(input->owner);
+	input->in_buffers++;
+	input->in_bytes += size;
+	input->demux_time += gst_util_get_timestamp() - start;
+	/* With a time-shift buffer the push ends once the data is written to it */
+	if (input->timeshift) {
+		input->timeshift_bytes += size;
+		input->timeshift_time += gst_util_get_timestamp() - start;
+	}
+	GST_OBJECT_UNLOCK(input->owner);
+
+	return ret;
+}
+
+/* Lists from upstream are split here rather than by typefind and the demuxer,
+ * which take buffers only, so every buffer is metered and counted */
+static GstFlowReturn
+inputSinkChainList (GstPad *pad, GstObject *parent, GstBufferList *list)
+{
+	GstFlowReturn ret = GST_FLOW_OK;
+	guint len = gst_buffer_list_length(list);
+	guint i;
+
+	for (i = 0; i < len && ret == GST_FLOW_OK; i++)
+		ret = inputSinkChain(pad, parent, gst_buffer_ref(gst_buffer_list_get(list, i)));
+	gst_buffer_list_unref(list);
+
+	return ret;
+}
+
+/* Pull mode. Recorded content is read through getrange so the demuxer can
+ * bisect the file on seeks instead of streaming up to the target. Live input
+ * stays in push mode: the scheduling query is answered here without asking
+ * upstream, which also keeps ingest batching in effect. */
+static gboolean
+inputSinkQuery (GstPad *pad, GstObject *parent, GstQuery *query)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) gst_pad_get_element_private(pad);
+	gboolean is_live;
+
+	if (GST_QUERY_TYPE(query) != GST_QUERY_SCHEDULING)
+		return gst_pad_query_default(pad, parent, query);
+
+	GST_OBJECT_LOCK(input->owner);
+	is_live = input->owner->is_live;
+	GST_OBJECT_UNLOCK(input->owner);
+	if (!is_live)
+		return gst_pad_query_default(pad, parent, query);
+
+	gst_query_set_scheduling(query, GST_SCHEDULING_FLAG_SEQUENTIAL, 1, -1, 0);
+	gst_query_add_scheduling_mode(query, GST_PAD_MODE_PUSH);
+	return TRUE;
+}
+
+static GstFlowReturn
+inputSinkGetRange (GstPad *pad, GstObject *parent, guint64 offset, guint length, GstBuffer **buffer)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) gst_pad_get_element_private(pad);
+	GstClockTime start = gst_util_get_timestamp();
+	GstFlowReturn ret;
+
+	input->in_offset = offset;
+	input->in_arrival = start;
+	ret = gst_proxy_pad_getrange_default(pad, parent, offset, length, buffer);
+	if (ret == GST_FLOW_OK)
+	{
+		tsHealthMeter(input, *buffer, start, offset != input->ts_health.next_offset);
+		input->ts_health.next_offset = offset + gst_buffer_get_size(*buffer);
+	}
+
+	GST_OBJECT_LOCK(input->owner);
+	input->in_pulls++;
+	if (ret == GST_FLOW_OK) {
+		input->in_buffers++;
+		input->in_bytes += gst_buffer_get_size(*buffer);
+	}
+	/* In pull mode the end of stream shows up here rather than as an event */
+	if (ret == GST_FLOW_OK || ret == GST_FLOW_EOS)
+		input->upstream_eos = (ret == GST_FLOW_EOS);
+	input->demux_time += gst_util_get_timestamp() - start;
+	GST_OBJECT_UNLOCK(input->owner);
+
+	return ret;
+}
+
+static gboolean
+inputSinkEvent (GstPad *pad, GstObject *parent, GstEvent *event)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) gst_pad_get_element_private(pad);
+
+	gboolean ret;
+
+	/* Pending data must not be overtaken by serialized events */
+	if (GST_EVENT_TYPE(event) == GST_EVENT_FLUSH_STOP)
+		ingestReset(input, FALSE);
+	else if (GST_EVENT_IS_SERIALIZED(event))
+		ingestPush(input, pad, parent, TRUE);
+
+	switch (GST_EVENT_TYPE(event)) {
+	case GST_EVENT_EOS:
+		GST_OBJECT_LOCK(input->owner);
+		input->upstream_eos = TRUE;
+		GST_OBJECT_UNLOCK(input->owner);
+		ret = gst_pad_event_default(pad, parent, event);
+		drainOrphanedChains(input);
+		return ret;
+	case GST_EVENT_FLUSH_STOP:
+	case GST_EVENT_STREAM_START:
+		GST_OBJECT_LOCK(input->owner);
+		input->upstream_eos = FALSE;
+		GST_OBJECT_UNLOCK(input->owner);
+		break;
+	default:
+		break;
+	}
+
+	return gst_pad_event_default(pad, parent, event);
+}
+
+static GstPadProbeReturn
+inputGateProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	GstPlayerSinkBin *playersinkbin = input->owner;
+	GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+	gboolean is_video = (pad == input->video_src);
+	GList *cache = NULL;
+	GList *l;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	if (!(is_video ? input->video_gate_open : input->audio_gate_open)) {
+		if (is_video) {
+			gsize size = gst_buffer_get_size(buffer);
+
+			if (!GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT) ||
+			    input->gop_cache_bytes + size > STANDBY_GOP_CACHE_MAX)
+				clearGopCache(input);
+			if (input->gop_cache || !GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+				input->gop_cache = g_list_append(input->gop_cache, gst_buffer_ref(buffer));
+				input->gop_cache_bytes += size;
+			}
+		}
+		GST_OBJECT_UNLOCK(playersinkbin);
+		return GST_PAD_PROBE_DROP;
+	}
+	if (is_video) {
+		cache = input->gop_cache;
+		input->gop_cache = NULL;
+		input->gop_cache_bytes = 0;
+		if (GST_CLOCK_TIME_IS_VALID(playersinkbin->swap_start)) {
+			playersinkbin->last_swap_latency = gst_util_get_timestamp() - playersinkbin->swap_start;
+			playersinkbin->swap_start = GST_CLOCK_TIME_NONE;
+		}
+		if (GST_CLOCK_TIME_IS_VALID(playersinkbin->seek_start) &&
+		    input == &playersinkbin->inputs[playersinkbin->active_input]) {
+			playersinkbin->last_seek_latency = gst_util_get_timestamp() - playersinkbin->seek_start;
+			playersinkbin->seek_start = GST_CLOCK_TIME_NONE;
+		}
+	}
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	/* First buffer after the swap: replay the GOP leading up to it so the
+	 * decoder starts from the last keyframe instead of waiting for the next */
+	for (l = cache; l; l = l->next)
+		gst_pad_push(pad, GST_BUFFER(l->data));
+	g_list_free(cache);
+
+	return GST_PAD_PROBE_OK;
+}
+
+/* Flushing seeks from the sinks: time them until the first video buffer after */
+static GstPadProbeReturn
+inputSeekProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+	GstSeekFlags flags;
+
+	if (GST_EVENT_TYPE(event) != GST_EVENT_SEEK)
+		return GST_PAD_PROBE_OK;
+	gst_event_parse_seek(event, NULL, NULL, &flags, NULL, NULL, NULL, NULL);
+	if (flags & GST_SEEK_FLAG_FLUSH) {
+		GST_OBJECT_LOCK(input->owner);
+		input->owner->seek_start = gst_util_get_timestamp();
+		GST_OBJECT_UNLOCK(input->owner);
+	}
+
+	return GST_PAD_PROBE_OK;
+}
+#endif
+
+static const gchar*
+getInputDemuxName (GstCaps *caps)
+{
+	const gchar *name = NULL;
+	guint i;
+
+	for (i = 0; i < G_N_ELEMENTS(input_containers) && !name; i++) {
+		GstCaps *container_caps = gst_caps_from_string(input_containers[i].caps);
+		if (gst_caps_can_intersect(caps, container_caps))
+			name = input_containers[i].demux;
+		gst_caps_unref(container_caps);
+	}
+
+	return name;
+}
+
+/* "have-type" from the input typefind: put the matching demuxer behind it, or
+ * treat its src pad like a demuxer pad when upstream already delivers ES */
+static void
+onInputTypeFound (GstElement *typefind, guint probability, GstCaps *caps, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	GstPlayerSinkBin *playersinkbin = input->owner;
+	const gchar *media = gst_structure_get_name(gst_caps_get_structure(caps, 0));
+	const gchar *demux_name;
+	GstPad *src_pad;
+	GstPad *sink_pad;
+
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : input type %" GST_PTR_FORMAT " (probability %u)\n", caps, probability);
+
+	src_pad = gst_element_get_static_pad(typefind, "src");
+	/* Restarted after a state change: keep the path plugged the first time */
+	if (gst_pad_is_linked(src_pad))
+	{
+		gst_object_unref(src_pad);
+		return;
+	}
+
+	demux_name = getInputDemuxName(caps);
+#ifdef USE_GST1
+	if (!g_strcmp0(media, "video/mpegts") && !input->ts_health.pids)
+		tsHealthStart(input, caps);
+	if (!g_strcmp0(demux_name, DEMUX) && input == &playersinkbin->inputs[0] && playersinkbin->mosaic_programs &&
+	    createMosaic(input, src_pad))
+	{
+		gst_object_unref(src_pad);
+		updateActiveInput(playersinkbin);
+		return;
+	}
+#endif
+	if (!demux_name)
+	{
+		if (getVideoCodec(caps) || g_str_has_prefix(media, "audio/"))
+			onDemuxSrcPadAdded(typefind, src_pad, playersinkbin);
+		else
+			GST_ERROR_OBJECT(playersinkbin,"playersinkbin : unsupported input type %s\n", media);
+		gst_object_unref(src_pad);
+		return;
+	}
+
+	input->demux = gst_element_factory_make(demux_name, "player_demux");
+	if (!input->demux)
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate demuxer (%s)\n", demux_name);
+		gst_object_unref(src_pad);
+		return;
+	}
+	if (g_object_class_find_property(G_OBJECT_GET_CLASS(input->demux), "program-number"))
+		g_object_set(input->demux, "program-number", playersinkbin->prog_no, NULL);
+#ifdef HAVE_GST_MPEGTS
+	if (playersinkbin->scte35_cues)
+	{
+		if (g_object_class_find_property(G_OBJECT_GET_CLASS(input->demux), "send-scte35-events"))
+			g_object_set(input->demux, "send-scte35-events", TRUE, NULL);
+		else
+			GST_WARNING_OBJECT(playersinkbin,"playersinkbin : %s does not send SCTE-35 cues\n", demux_name);
+	}
+#endif
+	g_signal_connect(input->demux, "pad-added", G_CALLBACK (onDemuxSrcPadAdded), playersinkbin);
+	gst_bin_add(GST_BIN(input->bin), input->demux);
+
+	sink_pad = gst_element_get_static_pad(input->demux, "sink");
+	if (!GST_PAD_LINK_SUCCESSFUL(gst_pad_link(src_pad, sink_pad)))
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to link typefind to %s\n", demux_name);
+	gst_object_unref(sink_pad);
+	gst_object_unref(src_pad);
+
+	gst_element_sync_state_with_parent(input->demux);
+	if (input == &playersinkbin->inputs[playersinkbin->active_input])
+		updateActiveInput(playersinkbin);
+}
+
+static gboolean
+createInput (GstPlayerSinkBin *playersinkbin, guint slot)
+{
+	GstPlayerSinkBinInput *input = &playersinkbin->inputs[slot];
+	gchar *name;
+	GstPad *pad;
+	GstPad *gpad;
+
+	memset(input, 0, sizeof(*input));
+	input->owner = playersinkbin;
+	input->ingest_first = GST_CLOCK_TIME_NONE;
+	name = g_strdup_printf("input%u", slot);
+	input->bin = gst_bin_new(name);
+	g_free(name);
+	input->typefind = gst_element_factory_make("typefind", "player_typefind");
+
+	if (!input->bin || !input->typefind)
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate typefind");
+		if (input->bin)
+			gst_object_unref(input->bin);
+		if (input->typefind)
+			gst_object_unref(input->typefind);
+		memset(input, 0, sizeof(*input));
+		return FALSE;
+	}
+	g_signal_connect(input->typefind, "have-type", G_CALLBACK (onInputTypeFound), input);
+	gst_bin_add(GST_BIN(input->bin), input->typefind);
+
+	/* get the sinkpad of typefind and ghost it on the front-end bin */
+	pad = gst_element_get_static_pad (input->typefind, "sink");
+	gpad = gst_ghost_pad_new ("sink", pad);
+	gst_object_unref(pad);
+#ifdef USE_GST1
+	gst_pad_set_element_private (gpad, input);
+	gst_pad_set_chain_function (gpad, GST_DEBUG_FUNCPTR (inputSinkChain));
+	gst_pad_set_chain_list_function (gpad, GST_DEBUG_FUNCPTR (inputSinkChainList));
+	gst_pad_set_event_function (gpad, GST_DEBUG_FUNCPTR (inputSinkEvent));
+	pad = GST_PAD (gst_proxy_pad_get_internal (GST_PROXY_PAD (gpad)));
+	gst_pad_set_element_private (pad, input);
+	gst_pad_set_query_function (pad, GST_DEBUG_FUNCPTR (inputSinkQuery));
+	gst_pad_set_getrange_function (pad, GST_DEBUG_FUNCPTR (inputSinkGetRange));
+	gst_object_unref(pad);
+#endif
+	gst_pad_set_active (gpad, TRUE);
+	gst_element_add_pad (input->bin, gpad);
+
+	input->video_gate_open = input->audio_gate_open = (slot == playersinkbin->active_input);
+	gst_bin_add(GST_BIN(playersinkbin), input->bin);
+
+	return TRUE;
+}
+
+static void
+destroyInput (GstPlayerSinkBin *playersinkbin, GstPlayerSinkBinInput *input)
+{
+	GstPlayerSinkBinTsPid *pids;
+	GstPad *pads[3];
+	guint i;
+
+	if (!input->bin)
+		return;
+
+	gst_element_set_state(input->bin, GST_STATE_NULL);
+	pads[0] = input->video_src;
+	pads[1] = input->audio_src;
+	pads[2] = input->ad_src;
+	for (i = 0; i < 3; i++) {
+		GstPad *peer = pads[i] ? gst_pad_get_peer(pads[i]) : NULL;
+		if (peer) {
+			gst_pad_unlink(pads[i], peer);
+			if (pads[i] == input->ad_src && playersinkbin->ad_mixer)
+				gst_element_release_request_pad(playersinkbin->ad_mixer, peer);
+			gst_object_unref(peer);
+		}
+	}
+	gst_bin_remove(GST_BIN(playersinkbin), input->bin);
+
+	GST_OBJECT_LOCK(playersinkbin);
+	clearGopCache(input);
+	gst_caps_replace(&input->video_caps, NULL);
+	GST_OBJECT_UNLOCK(playersinkbin);
+#ifdef USE_GST1
+	ingestReset(input, TRUE);
+#endif
+	gst_caps_replace(&input->audio_caps, NULL);
+	g_list_free(input->video_retired);
+	g_list_free(input->audio_retired);
+	if (input->video_pending)
+		gst_object_unref(input->video_pending);
+	if (input->audio_pending)
+		gst_object_unref(input->audio_pending);
+	if (input->video_waiting)
+		gst_object_unref(input->video_waiting);
+	if (input->audio_waiting)
+		gst_object_unref(input->audio_waiting);
+	/* Hidden from the health tick before it goes */
+	GST_OBJECT_LOCK(playersinkbin);
+	pids = input->ts_health.pids;
+	input->ts_health.pids = NULL;
+	GST_OBJECT_UNLOCK(playersinkbin);
+	g_free(pids);
+	memset(input, 0, sizeof(*input));
+}
+
+/* Time-shift buffer.
+ * A queue2 in ring buffer mode between the input's ghost pad and typefind,
+ * sized for "timeshift-duration" at "timeshift-bitrate". It lives in RAM or,
+ * with "timeshift-location", in a file there. Live input keeps being written
+ * while the sinks are paused, and the demuxer pulls from the ring so it can
+ * seek back into it and catch up to live again. Writes arrive in ingest-chunk
+ * sized blocks and land in memory allocated once for the ring.
+ * Called in READY, where the pads can be relinked freely.
+ */
+static void
+configureTimeshift (GstPlayerSinkBin *playersinkbin, GstPlayerSinkBinInput *input)
+{
+	GstPad *gpad;
+	GstPad *pad;
+	guint64 duration;
+	guint64 size;
+	gchar *location;
+
+	if (!input->bin)
+		return;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	duration = playersinkbin->timeshift_duration;
+	size = gst_util_uint64_scale(duration, playersinkbin->timeshift_bitrate / 8, GST_SECOND);
+	location = playersinkbin->timeshift_location ?
+	    g_build_filename(playersinkbin->timeshift_location, "playersinkbin-XXXXXX", NULL) : NULL;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	gpad = gst_element_get_static_pad(input->bin, "sink");
+	if (input->timeshift && size == 0)
+	{
+		/* Disabled: feed typefind directly again */
+		pad = gst_element_get_static_pad(input->typefind, "sink");
+		gst_element_unlink(input->timeshift, input->typefind);
+		gst_ghost_pad_set_target(GST_GHOST_PAD(gpad), pad);
+		gst_object_unref(pad);
+		gst_element_set_state(input->timeshift, GST_STATE_NULL);
+		gst_bin_remove(GST_BIN(input->bin), input->timeshift);
+		input->timeshift = NULL;
+	}
+	else if (!input->timeshift && size > 0)
+	{
+		input->timeshift = gst_element_factory_make("queue2", "timeshift");
+		if (!input->timeshift)
+		{
+			GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate time-shift buffer\n");
+			goto done;
+		}
+		gst_bin_add(GST_BIN(input->bin), input->timeshift);
+		if (!gst_element_link(input->timeshift, input->typefind))
+			GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to link time-shift buffer\n");
+		pad = gst_element_get_static_pad(input->timeshift, "sink");
+		gst_ghost_pad_set_target(GST_GHOST_PAD(gpad), pad);
+		gst_object_unref(pad);
+		gst_element_sync_state_with_parent(input->timeshift);
+	}
+	if (input->timeshift)
+	{
+		g_object_set(input->timeshift, "ring-buffer-max-size", size, "max-size-bytes", (guint) MIN(size, G_MAXUINT),
+		    "max-size-buffers", 0, "max-size-time", (guint64) 0, "temp-template", location, NULL);
+		GST_INFO_OBJECT(playersinkbin,"playersinkbin : time-shift buffer of %" G_GUINT64_FORMAT " bytes in %s\n",
+		    size, location ? location : "RAM");
+	}
+done:
+	gst_object_unref(gpad);
+	g_free(location);
+}
+
+#ifdef USE_GST1
+/* Stream changes at segment boundaries.
+ * A PMT or codec change between consecutive segments makes the demuxer add
+ * new pads and end the old ones with EOS. That EOS is held back at the old
+ * pad so the sinks never see it, and the chain it fed is left orphaned until
+ * a pad of the same kind is plugged. With the same stream type the new pad is
+ * simply linked to the orphaned queue. Otherwise the old chain is drained
+ * with the EOS it was spared, a new chain is built next to it with its output
+ * blocked, and once the EOS reaches the ghost pad the ghost is retargeted to
+ * the new chain and the old one is torn down. A real end of stream from
+ * upstream still drains orphaned chains to the sinks. A new pad whose first
+ * segment comes before the old pad's EOS waits, its buffers dropped, and is
+ * plugged when that EOS arrives.
+ */
+static GstPad* addInputOutput (GstPlayerSinkBinInput *input, GstElement *element, const gchar *name);
+static GstPadProbeReturn dropProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data);
+static void plug_pad (GstPlayerSinkBin * playersinkbin, GstPad * demux_src_pad);
+
+typedef struct _StreamChange
+{
+	GstPlayerSinkBinInput *input;
+	gboolean is_video;
+} StreamChange;
+
+static gboolean
+sameStreamType (GstCaps *caps, GstCaps *other)
+{
+	GstStructure *s1;
+	GstStructure *s2;
+	gint v1 = 0;
+	gint v2 = 0;
+
+	if (!caps || !other)
+		return FALSE;
+	s1 = gst_caps_get_structure(caps, 0);
+	s2 = gst_caps_get_structure(other, 0);
+	gst_structure_get_int(s1, "mpegversion", &v1);
+	gst_structure_get_int(s2, "mpegversion", &v2);
+
+	return gst_structure_has_name(s1, gst_structure_get_name(s2)) && v1 == v2;
+}
+
+static GstPadProbeReturn
+demuxPadEosProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+	GstPad *peer;
+	GstElement *queue;
+	GstPad *waiting = NULL;
+	gulong waiting_probe = 0;
+
+	if (GST_EVENT_TYPE(event) != GST_EVENT_EOS)
+		return GST_PAD_PROBE_OK;
+
+	GST_OBJECT_LOCK(input->owner);
+	if (input->upstream_eos) {
+		GST_OBJECT_UNLOCK(input->owner);
+		return GST_PAD_PROBE_OK;
+	}
+	GST_OBJECT_UNLOCK(input->owner);
+
+	peer = gst_pad_get_peer(pad);
+	queue = peer ? gst_pad_get_parent_element(peer) : NULL;
+	GST_OBJECT_LOCK(input->owner);
+	if (queue && queue == input->m_vqueue)
+	{
+		input->video_orphaned = TRUE;
+		waiting = input->video_waiting;
+		waiting_probe = input->video_waiting_probe;
+		input->video_waiting = NULL;
+		input->video_waiting_probe = 0;
+	}
+	else if (queue && queue == input->m_aqueue)
+	{
+		input->audio_orphaned = TRUE;
+		waiting = input->audio_waiting;
+		waiting_probe = input->audio_waiting_probe;
+		input->audio_waiting = NULL;
+		input->audio_waiting_probe = 0;
+	}
+	GST_OBJECT_UNLOCK(input->owner);
+	GST_INFO_OBJECT(input->owner, "playersinkbin : %s:%s ended mid-stream, holding back its EOS", GST_DEBUG_PAD_NAME(pad));
+	if (queue)
+		gst_object_unref(queue);
+	if (peer)
+		gst_object_unref(peer);
+
+	/* Its replacement came first, take over the chain now */
+	if (waiting)
+	{
+		GST_INFO_OBJECT(input->owner, "playersinkbin : plugging waiting %s:%s", GST_DEBUG_PAD_NAME(waiting));
+		plug_pad(input->owner, waiting);
+		gst_pad_remove_probe(waiting, waiting_probe);
+		gst_object_unref(waiting);
+	}
+
+	return GST_PAD_PROBE_DROP;
+}
+
+/* Link a demuxer pad to the queue of a chain and watch it for EOS */
+static gboolean
+linkDemuxPad (GstPlayerSinkBinInput *input, GstPad *demux_src_pad, GstElement *queue)
+{
+	GstPad *sink_pad = gst_element_get_static_pad(queue, "sink");
+	GstPad *old = gst_pad_get_peer(sink_pad);
+	gboolean linked;
+
+	if (old) {
+		gst_pad_unlink(old, sink_pad);
+		gst_object_unref(old);
+	}
+	linked = GST_PAD_LINK_SUCCESSFUL(gst_pad_link(demux_src_pad, sink_pad));
+	if (linked)
+		gst_pad_add_probe(demux_src_pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, demuxPadEosProbe, input, NULL);
+	gst_object_unref(sink_pad);
+
+	return linked;
+}
+
+static void
+drainOrphanedChains (GstPlayerSinkBinInput *input)
+{
+	GstElement *queues[2] = { NULL, NULL };
+	guint i;
+
+	GST_OBJECT_LOCK(input->owner);
+	if (input->video_orphaned && input->m_vqueue)
+		queues[0] = gst_object_ref(input->m_vqueue);
+	if (input->audio_orphaned && input->m_aqueue)
+		queues[1] = gst_object_ref(input->m_aqueue);
+	input->video_orphaned = input->audio_orphaned = FALSE;
+	GST_OBJECT_UNLOCK(input->owner);
+
+	for (i = 0; i < 2; i++) {
+		if (!queues[i])
+			continue;
+		gst_element_send_event(queues[i], gst_event_new_eos());
+		gst_object_unref(queues[i]);
+	}
+}
+
+static gboolean
+isOrphaned (GstPlayerSinkBinInput *input, gboolean is_video)
+{
+	gboolean orphaned;
+
+	GST_OBJECT_LOCK(input->owner);
+	orphaned = is_video ? input->video_orphaned : input->audio_orphaned;
+	GST_OBJECT_UNLOCK(input->owner);
+
+	return orphaned;
+}
+
+/* Hold a new demuxer pad while the chain of its kind is still fed by another
+ * pad, until that pad ends. Returns FALSE when the other pad already ended. */
+static gboolean
+waitDemuxPad (GstPlayerSinkBinInput *input, GstPad *demux_src_pad, gboolean is_video)
+{
+	GstPad **waiting = is_video ? &input->video_waiting : &input->audio_waiting;
+	gulong *probe = is_video ? &input->video_waiting_probe : &input->audio_waiting_probe;
+	GstPad *old = NULL;
+	gulong old_probe = 0;
+
+	GST_OBJECT_LOCK(input->owner);
+	if (is_video ? input->video_orphaned : input->audio_orphaned)
+	{
+		GST_OBJECT_UNLOCK(input->owner);
+		return FALSE;
+	}
+	old = *waiting;
+	old_probe = *probe;
+	*waiting = gst_object_ref(demux_src_pad);
+	*probe = gst_pad_add_probe(demux_src_pad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+	    dropProbe, NULL, NULL);
+	GST_OBJECT_UNLOCK(input->owner);
+	GST_INFO_OBJECT(input->owner, "playersinkbin : %s:%s waits for the %s stream it replaces to end",
+	    GST_DEBUG_PAD_NAME(demux_src_pad), is_video ? "video" : "audio");
+	/* Only the latest pad is kept, an earlier one stays unplugged */
+	if (old)
+		gst_object_unref(old);
+
+	return TRUE;
+}
+
+/* Called for a new demuxer pad while a chain of its kind is orphaned. Returns
+ * TRUE when the pad took over that chain; otherwise the chain is retired and
+ * the caller builds a new one. */
+static gboolean
+plugStreamChange (GstPlayerSinkBin *playersinkbin, GstPlayerSinkBinInput *input, GstPad *demux_src_pad,
+    GstCaps *caps, gboolean is_video)
+{
+	GstElement *queue = is_video ? input->m_vqueue : input->m_aqueue;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	if (is_video)
+		input->video_orphaned = FALSE;
+	else
+		input->audio_orphaned = FALSE;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	if (sameStreamType(caps, is_video ? input->video_caps : input->audio_caps) &&
+	    linkDemuxPad(input, demux_src_pad, queue))
+	{
+		GST_INFO_OBJECT(playersinkbin, "playersinkbin : reusing %s chain for %" GST_PTR_FORMAT, is_video ? "video" : "audio", caps);
+		return TRUE;
+	}
+
+	GST_INFO_OBJECT(playersinkbin, "playersinkbin : replacing %s chain for %" GST_PTR_FORMAT, is_video ? "video" : "audio", caps);
+	gst_element_send_event(queue, gst_event_new_eos());
+	GST_OBJECT_LOCK(playersinkbin);
+	if (is_video)
+	{
+		input->video_retired = g_list_prepend(input->video_retired, input->m_vqueue);
+		input->video_retired = g_list_prepend(input->video_retired, input->video_parser);
+		if (input->video_decoder)
+			input->video_retired = g_list_prepend(input->video_retired, input->video_decoder);
+		if (input->video_deinterlace)
+			input->video_retired = g_list_prepend(input->video_retired, input->video_deinterlace);
+		input->video_deinterlace = NULL;
+		input->m_vqueue = input->video_parser = input->video_decoder = NULL;
+	}
+	else
+	{
+		input->audio_retired = g_list_prepend(input->audio_retired, input->m_aqueue);
+		input->audio_retired = g_list_prepend(input->audio_retired, input->m_audio_parser);
+		input->audio_retired = g_list_prepend(input->audio_retired, input->m_adec);
+		input->m_aqueue = input->m_audio_parser = input->m_adec = NULL;
+		input->audio_linked = FALSE;
+	}
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	return FALSE;
+}
+
+/* Hook up the output of a chain: a new ghost pad the first time, afterwards
+ * the replacement chain waits blocked until the retired one has drained */
+static GstPad*
+setChainOutput (GstPlayerSinkBinInput *input, GstElement *element, gboolean is_video)
+{
+	GstPad *src_pad;
+	gboolean replacing;
+
+	GST_OBJECT_LOCK(input->owner);
+	replacing = (is_video ? input->video_retired : input->audio_retired) != NULL;
+	GST_OBJECT_UNLOCK(input->owner);
+	if (!replacing)
+		return addInputOutput(input, element, is_video ? "video_src" : "audio_src");
+
+	src_pad = gst_element_get_static_pad(element, "src");
+	GST_OBJECT_LOCK(input->owner);
+	if (is_video)
+	{
+		input->video_pending = src_pad;
+		input->video_pending_probe = gst_pad_add_probe(src_pad, GST_PAD_PROBE_TYPE_BLOCK_DOWNSTREAM, NULL, NULL, NULL);
+	}
+	else
+	{
+		input->audio_pending = src_pad;
+		input->audio_pending_probe = gst_pad_add_probe(src_pad, GST_PAD_PROBE_TYPE_BLOCK_DOWNSTREAM, NULL, NULL, NULL);
+	}
+	GST_OBJECT_UNLOCK(input->owner);
+	return is_video ? input->video_src : input->audio_src;
+}
+
+static void
+completeStreamChange (GstElement *element, gpointer data)
+{
+	StreamChange *change = (StreamChange *) data;
+	GstPlayerSinkBinInput *input = change->input;
+	GstPad *ghost = change->is_video ? input->video_src : input->audio_src;
+	GstPad **pending = change->is_video ? &input->video_pending : &input->audio_pending;
+	gulong *probe = change->is_video ? &input->video_pending_probe : &input->audio_pending_probe;
+	GList **retired = change->is_video ? &input->video_retired : &input->audio_retired;
+	GstPad *src_pad;
+	gulong src_probe;
+	GList *elements;
+	GList *l;
+
+	GST_OBJECT_LOCK(input->owner);
+	src_pad = *pending;
+	src_probe = *probe;
+	elements = *retired;
+	*pending = NULL;
+	*probe = 0;
+	*retired = NULL;
+	GST_OBJECT_UNLOCK(input->owner);
+
+	if (src_pad)
+	{
+		gst_ghost_pad_set_target(GST_GHOST_PAD(ghost), src_pad);
+		gst_pad_remove_probe(src_pad, src_probe);
+		gst_object_unref(src_pad);
+	}
+	for (l = elements; l; l = l->next) {
+		gst_element_set_state(GST_ELEMENT(l->data), GST_STATE_NULL);
+		gst_bin_remove(GST_BIN(input->bin), GST_ELEMENT(l->data));
+	}
+	g_list_free(elements);
+	GST_INFO_OBJECT(input->owner, "playersinkbin : %s chain switched", change->is_video ? "video" : "audio");
+}
+
+/* EOS leaving an input: when it ends a retired chain, switch to its replacement */
+static GstPadProbeReturn
+outputEosProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	gboolean is_video = (pad == input->video_src);
+	gboolean retired;
+	gboolean pending;
+	StreamChange *change;
+
+	if (GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info)) != GST_EVENT_EOS || pad == input->ad_src)
+		return GST_PAD_PROBE_OK;
+	/* Drain of a parser/decoder being swapped for a codec change, or the EOS a
+	 * queue sends after a downstream error while the chain is restarted */
+	if (is_video && input->video_reconfiguring)
+		return GST_PAD_PROBE_DROP;
+	if ((is_video ? &input->owner->video_watch : &input->owner->audio_watch)->restarting)
+		return GST_PAD_PROBE_DROP;
+	GST_OBJECT_LOCK(input->owner);
+	retired = (is_video ? input->video_retired : input->audio_retired) != NULL;
+	pending = (is_video ? input->video_pending : input->audio_pending) != NULL;
+	GST_OBJECT_UNLOCK(input->owner);
+	if (!retired)
+		return GST_PAD_PROBE_OK;
+
+	/* Not from this thread, it belongs to the chain being removed */
+	change = g_new0(StreamChange, 1);
+	change->input = input;
+	change->is_video = is_video;
+	gst_element_call_async(GST_ELEMENT(input->owner), completeStreamChange, change, g_free);
+
+	return pending ? GST_PAD_PROBE_DROP : GST_PAD_PROBE_OK;
+}
+#endif
+
+#ifdef USE_GST1
+/* Stall watchdog.
+ * The sinks' pads record when they last got a buffer. While PLAYING a periodic
+ * clock callback checks them every half "watchdog-timeout": an output that got
+ * nothing for the timeout while its input kept receiving data is stalled.
+ * Errors posted by elements of an output chain are caught in handle_message.
+ * Either way only that chain is restarted, without touching the pipeline:
+ * data from the demuxer is dropped meanwhile so upstream never sees an error
+ * flow, the chain is flushed from its queue, the faulty elements are reset and
+ * the flush is stopped. The flush wipes the stream's segment below the queue
+ * while the demuxer believes it delivered, so the demuxer's sticky events are
+ * sent again after it, and video stays dropped up to the next keyframe. After
+ * WATCHDOG_MAX_ATTEMPTS restarts without a buffer reaching the sink the error
+ * goes to the application. Recovery time is reported against the GOP
+ * duration seen at the video sink.
+ */
+typedef struct _ChainRestart
+{
+	gboolean is_video;
+	gboolean stalled;
+	GstElement *element; /* element that failed, NULL on stalls */
+} ChainRestart;
+
+static GstPadProbeReturn
+watchSinkProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN (data);
+	gboolean is_video = (GST_PAD_PARENT(pad) == playersinkbin->video_sink);
+	GstPlayerSinkBinWatch *watch = is_video ? &playersinkbin->video_watch : &playersinkbin->audio_watch;
+	GstClockTime recovery = GST_CLOCK_TIME_NONE;
+	GstClockTime gop = GST_CLOCK_TIME_NONE;
+	GstBuffer *buffer = NULL;
+
+	if (info->type & GST_PAD_PROBE_TYPE_BUFFER)
+		buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+	GST_OBJECT_LOCK(playersinkbin);
+	/* Decoders carry the sync point flag over to their frames */
+	if (is_video && buffer && GST_BUFFER_PTS_IS_VALID(buffer) &&
+	    !GST_BUFFER_FLAG_IS_SET(buffer, GST_BUFFER_FLAG_DELTA_UNIT)) {
+		if (GST_CLOCK_TIME_IS_VALID(watch->last_keyframe) && GST_BUFFER_PTS(buffer) > watch->last_keyframe)
+			watch->gop = GST_BUFFER_PTS(buffer) - watch->last_keyframe;
+		watch->last_keyframe = GST_BUFFER_PTS(buffer);
+	}
+	watch->last_buffer = gst_util_get_timestamp();
+	watch->in_buffers = playersinkbin->inputs[playersinkbin->active_input].in_buffers;
+	watch->attempts = 0;
+	if (GST_CLOCK_TIME_IS_VALID(watch->restart_start) && !watch->restarting) {
+		recovery = watch->last_recovery = watch->last_buffer - watch->restart_start;
+		watch->restart_start = GST_CLOCK_TIME_NONE;
+	}
+	gop = playersinkbin->video_watch.gop;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	if (GST_CLOCK_TIME_IS_VALID(recovery))
+	{
+		if (GST_CLOCK_TIME_IS_VALID(gop) && recovery > gop)
+			GST_WARNING_OBJECT(playersinkbin,"playersinkbin : %s recovery took %" GST_TIME_FORMAT ", longer than a GOP (%" GST_TIME_FORMAT ")\n",
+			    is_video ? "video" : "audio", GST_TIME_ARGS(recovery), GST_TIME_ARGS(gop));
+		gst_element_post_message(GST_ELEMENT(playersinkbin),
+		    gst_message_new_element(GST_OBJECT(playersinkbin),
+		        gst_structure_new("playersinkbin-recovered",
+		            "stream", G_TYPE_STRING, is_video ? "video" : "audio",
+		            "recovery-time", G_TYPE_UINT64, recovery,
+		            "gop-duration", G_TYPE_UINT64, gop, NULL)));
+	}
+
+	return GST_PAD_PROBE_OK;
+}
+
+static void
+watchSink (GstPlayerSinkBin *playersinkbin, GstElement *sink)
+{
+	GstPad *pad = gst_element_get_static_pad(sink, "sink");
+
+	gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST, watchSinkProbe, playersinkbin, NULL);
+	gst_object_unref(pad);
+}
+
+static GstPadProbeReturn
+dropProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	return GST_PAD_PROBE_DROP;
+}
+
+/* After a restart the decoder can only start from a keyframe */
+static GstPadProbeReturn
+keyframeGateProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	if (GST_BUFFER_FLAG_IS_SET(GST_PAD_PROBE_INFO_BUFFER(info), GST_BUFFER_FLAG_DELTA_UNIT))
+		return GST_PAD_PROBE_DROP;
+	return GST_PAD_PROBE_REMOVE;
+}
+
+static void
+doRestartChain (GstElement *element, gpointer data)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN (element);
+	ChainRestart *restart = (ChainRestart *) data;
+	GstPlayerSinkBinInput *input = &playersinkbin->inputs[playersinkbin->active_input];
+	GstPlayerSinkBinWatch *watch = restart->is_video ? &playersinkbin->video_watch : &playersinkbin->audio_watch;
+	GstElement *queue = restart->is_video ? input->m_vqueue : input->m_aqueue;
+	GstElement *reset[3] = { NULL, NULL, NULL };
+	GstEventType sticky[3] = { GST_EVENT_STREAM_START, GST_EVENT_CAPS, GST_EVENT_SEGMENT };
+	GstEvent *events[3] = { NULL, NULL, NULL };
+	GstPad *queue_sink;
+	guint i;
+
+	if (restart->element && restart->element != queue)
+		reset[0] = restart->element;
+	else if (restart->is_video)
+	{
+		reset[0] = input->video_parser;
+		reset[1] = input->video_decoder;
+		/* A stall that survived a decoder restart: the sink is next */
+		if (restart->stalled && watch->attempts > 1)
+			reset[2] = playersinkbin->video_sink;
+	}
+	else
+	{
+		reset[0] = input->m_audio_parser;
+		reset[1] = input->m_adec;
+		if (restart->stalled && watch->attempts > 1)
+			reset[2] = playersinkbin->audio_sink;
+	}
+
+	if (queue)
+	{
+		/* The demuxer does not see this flush and will not send these again */
+		for (i = 0; i < 3 && watch->drop_pad; i++)
+			events[i] = gst_pad_get_sticky_event(watch->drop_pad, sticky[i], 0);
+		queue_sink = gst_element_get_static_pad(queue, "sink");
+		gst_pad_send_event(queue_sink, gst_event_new_flush_start());
+		for (i = 0; i < 3; i++) {
+			if (!reset[i])
+				continue;
+			GST_INFO_OBJECT(playersinkbin,"playersinkbin : restarting %s\n", GST_ELEMENT_NAME(reset[i]));
+			gst_element_set_state(reset[i], GST_STATE_READY);
+			gst_element_sync_state_with_parent(reset[i]);
+		}
+		gst_pad_send_event(queue_sink, gst_event_new_flush_stop(FALSE));
+		for (i = 0; i < 3; i++) {
+			if (events[i])
+				gst_pad_send_event(queue_sink, events[i]);
+		}
+		gst_object_unref(queue_sink);
+	}
+
+	GST_OBJECT_LOCK(playersinkbin);
+	watch->restarting = FALSE;
+	GST_OBJECT_UNLOCK(playersinkbin);
+	if (watch->drop_pad)
+	{
+		/* Gate first so no delta frame slips in between */
+		if (restart->is_video)
+			gst_pad_add_probe(watch->drop_pad, GST_PAD_PROBE_TYPE_BUFFER, keyframeGateProbe, NULL, NULL);
+		gst_pad_remove_probe(watch->drop_pad, watch->drop_probe);
+		gst_object_unref(watch->drop_pad);
+		watch->drop_pad = NULL;
+	}
+}
+
+static void
+freeChainRestart (gpointer data)
+{
+	ChainRestart *restart = (ChainRestart *) data;
+
+	if (restart->element)
+		gst_object_unref(restart->element);
+	g_free(restart);
+}
+
+/* Flush an output chain of the active input and reset element in it, or its
+ * parser and decoder when NULL. The caller has set the watch restarting. */
+static void
+resetChain (GstPlayerSinkBin *playersinkbin, gboolean is_video, GstElement *element)
+{
+	GstPlayerSinkBinInput *input = &playersinkbin->inputs[playersinkbin->active_input];
+	GstPlayerSinkBinWatch *watch = is_video ? &playersinkbin->video_watch : &playersinkbin->audio_watch;
+	GstElement *queue = is_video ? input->m_vqueue : input->m_aqueue;
+	ChainRestart *restart;
+	GstPad *queue_sink;
+
+	/* From now on the demuxer's data for this chain goes nowhere, quietly */
+	queue_sink = gst_element_get_static_pad(queue, "sink");
+	watch->drop_pad = gst_pad_get_peer(queue_sink);
+	gst_object_unref(queue_sink);
+	if (watch->drop_pad)
+		watch->drop_probe = gst_pad_add_probe(watch->drop_pad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+		    dropProbe, NULL, NULL);
+
+	restart = g_new0(ChainRestart, 1);
+	restart->is_video = is_video;
+	restart->stalled = (element == NULL);
+	restart->element = element ? gst_object_ref(element) : NULL;
+	gst_element_call_async(GST_ELEMENT(playersinkbin), doRestartChain, restart, freeChainRestart);
+}
+
+/* Schedule a restart of an output chain of the active input, FALSE once the
+ * attempts are used up */
+static gboolean
+restartChain (GstPlayerSinkBin *playersinkbin, gboolean is_video, GstElement *element, const gchar *reason)
+{
+	GstPlayerSinkBinInput *input = &playersinkbin->inputs[playersinkbin->active_input];
+	GstPlayerSinkBinWatch *watch = is_video ? &playersinkbin->video_watch : &playersinkbin->audio_watch;
+	GstElement *queue = is_video ? input->m_vqueue : input->m_aqueue;
+	GstClockTime now = gst_util_get_timestamp();
+	GstClockTime stall;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	if (watch->restarting) {
+		GST_OBJECT_UNLOCK(playersinkbin);
+		return TRUE;
+	}
+	if (!queue || watch->attempts >= WATCHDOG_MAX_ATTEMPTS) {
+		GST_OBJECT_UNLOCK(playersinkbin);
+		return FALSE;
+	}
+	watch->restarting = TRUE;
+	watch->attempts++;
+	watch->restarts++;
+	if (!GST_CLOCK_TIME_IS_VALID(watch->restart_start))
+		watch->restart_start = now;
+	stall = GST_CLOCK_TIME_IS_VALID(watch->last_buffer) ? now - watch->last_buffer : 0;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	GST_WARNING_OBJECT(playersinkbin,"playersinkbin : restarting %s chain (%s), %" GST_TIME_FORMAT " since the last buffer\n",
+	    is_video ? "video" : "audio", reason, GST_TIME_ARGS(stall));
+	gst_element_post_message(GST_ELEMENT(playersinkbin),
+	    gst_message_new_element(GST_OBJECT(playersinkbin),
+	        gst_structure_new("playersinkbin-restart",
+	            "stream", G_TYPE_STRING, is_video ? "video" : "audio",
+	            "reason", G_TYPE_STRING, reason,
+	            "element", G_TYPE_STRING, element ? GST_ELEMENT_NAME(element) : "",
+	            "stall-time", G_TYPE_UINT64, stall,
+	            "attempt", G_TYPE_UINT, watch->attempts, NULL)));
+	postEvent (playersinkbin, is_video ? GSTPLAYERSINKBIN_EVENT_VIDEO_RESTARTED : GSTPLAYERSINKBIN_EVENT_AUDIO_RESTARTED);
+	resetChain(playersinkbin, is_video, element);
+
+	return TRUE;
+}
+
+/* Output chain of the active input an element belongs to: 1 video, 0 audio,
+ * -1 none. The element is moved up to the chain's direct child. */
+static gint
+getChainForElement (GstPlayerSinkBin *playersinkbin, GstElement **element)
+{
+	GstPlayerSinkBinInput *input = &playersinkbin->inputs[playersinkbin->active_input];
+	GstObject *object = GST_OBJECT(*element);
+
+	for (; object && object != GST_OBJECT(playersinkbin); object = GST_OBJECT_PARENT(object)) {
+		GstElement *e = (GstElement *) object;
+
+		if (e == input->m_vqueue || e == input->video_parser || e == input->video_decoder || e == input->video_deinterlace ||
+		    e == playersinkbin->vrate || e == playersinkbin->m_vscalar || e == playersinkbin->m_vfilter ||
+		    e == playersinkbin->vconvert || e == playersinkbin->video_sink) {
+			*element = e;
+			return 1;
+		}
+		if (e == input->m_aqueue || e == input->m_audio_parser || e == input->m_adec ||
+		    e == playersinkbin->ad_mixer || e == playersinkbin->m_aconvert || e == playersinkbin->m_scaletempo ||
+		    e == playersinkbin->m_resample ||
+		    e == playersinkbin->audio_sink) {
+			*element = e;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/* Called from handle_message, TRUE when the error is dealt with here */
+static gboolean
+watchdogHandleError (GstPlayerSinkBin *playersinkbin, GstMessage *message)
+{
+	GstElement *element;
+	gint chain;
+
+	if (!playersinkbin->watchdog_id || !GST_IS_ELEMENT(GST_MESSAGE_SRC(message)))
+		return FALSE;
+	element = GST_ELEMENT(GST_MESSAGE_SRC(message));
+	chain = getChainForElement(playersinkbin, &element);
+	if (chain < 0)
+		return FALSE;
+
+	return restartChain(playersinkbin, chain, element, "error");
+}
+
+static gboolean
+watchdogTick (GstClock *clock, GstClockTime time, GstClockID id, gpointer data)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN (data);
+	GstPlayerSinkBinInput *input = &playersinkbin->inputs[playersinkbin->active_input];
+	GstClockTime now = gst_util_get_timestamp();
+	gboolean stalled[2];
+	guint i;
+
+	if (!tickEnter(playersinkbin, &playersinkbin->watchdog_id, id, &playersinkbin->watchdog_thread))
+		return TRUE;
+	GST_OBJECT_LOCK(playersinkbin);
+	for (i = 0; i < 2; i++) {
+		GstPlayerSinkBinWatch *watch = i ? &playersinkbin->video_watch : &playersinkbin->audio_watch;
+
+		stalled[i] = (i ? input->video_src : input->audio_src) && !watch->restarting &&
+		    GST_CLOCK_TIME_IS_VALID(watch->last_buffer) &&
+		    now - watch->last_buffer > playersinkbin->watchdog_timeout &&
+		    input->in_buffers != watch->in_buffers;
+	}
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	for (i = 0; i < 2; i++) {
+		if (stalled[i] && !restartChain(playersinkbin, i, NULL, "stall"))
+			GST_WARNING_OBJECT(playersinkbin,"playersinkbin : %s output stalled, giving up restarting it\n", i ? "video" : "audio");
+	}
+	tickLeave(playersinkbin, &playersinkbin->watchdog_thread);
+
+	return TRUE;
+}
+
+static void
+watchdogStart (GstPlayerSinkBin *playersinkbin)
+{
+	GstClock *clock;
+	GstClockTime now = gst_util_get_timestamp();
+	GstClockTime timeout;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	timeout = playersinkbin->watchdog_timeout;
+	/* Give the outputs a full timeout to start flowing */
+	playersinkbin->video_watch.last_buffer = playersinkbin->audio_watch.last_buffer = now;
+	playersinkbin->video_watch.attempts = playersinkbin->audio_watch.attempts = 0;
+	GST_OBJECT_UNLOCK(playersinkbin);
+	if (timeout == 0 || playersinkbin->watchdog_id)
+		return;
+
+	clock = gst_system_clock_obtain();
+	GST_OBJECT_LOCK(playersinkbin);
+	playersinkbin->watchdog_id = gst_clock_new_periodic_id(clock, gst_clock_get_time(clock) + timeout, timeout / 2);
+	gst_clock_id_wait_async(playersinkbin->watchdog_id, watchdogTick, playersinkbin, NULL);
+	GST_OBJECT_UNLOCK(playersinkbin);
+	gst_object_unref(clock);
+}
+
+static void
+watchdogStop (GstPlayerSinkBin *playersinkbin)
+{
+	tickStop(playersinkbin, &playersinkbin->watchdog_id, &playersinkbin->watchdog_thread);
+}
+#endif
+
+/* Ghost the src pad of the last element of an input chain on the input bin */
+static GstPad*
+addInputOutput (GstPlayerSinkBinInput *input, GstElement *element, const gchar *name)
+{
+	GstPad *target;
+	GstPad *gpad;
+
+	target = gst_element_get_static_pad(element, "src");
+	gpad = gst_ghost_pad_new(name, target);
+	gst_object_unref(target);
+#ifdef USE_GST1
+	gst_pad_add_probe(gpad, GST_PAD_PROBE_TYPE_BUFFER, inputGateProbe, input, NULL);
+	gst_pad_add_probe(gpad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, outputEosProbe, input, NULL);
+	if (!strcmp(name, "video_src"))
+		gst_pad_add_probe(gpad, GST_PAD_PROBE_TYPE_EVENT_UPSTREAM, inputSeekProbe, input, NULL);
+#endif
+	gst_pad_set_active(gpad, TRUE);
+	gst_element_add_pad(input->bin, gpad);
+
+	return gpad;
+}
+
+static gboolean
+ensureVideoSink (GstPlayerSinkBin *playersinkbin)
+{
+	if (playersinkbin->video_sink)
+		return TRUE;
+
+	playersinkbin->video_sink = mediaConfMake(playersinkbin, "sink", "video", VSINK, "player_vsink");
+	if (!playersinkbin->video_sink)
+	{
+		GST_WARNING_OBJECT(playersinkbin,"playersinkbin : configured video sink not available, falling back to %s\n", VSINK_FALLBACK);
+		playersinkbin->video_sink = gst_element_factory_make(VSINK_FALLBACK, "player_vsink");
+	}
+	if (!playersinkbin->video_sink)
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate video sink (%s)\n", VSINK_FALLBACK);
+		return FALSE;
+	}
+	gst_bin_add(GST_BIN(playersinkbin), playersinkbin->video_sink);
+#ifdef USE_GST1
+	watchSink(playersinkbin, playersinkbin->video_sink);
+#endif
+	if (playersinkbin->rect_width && videoSinkScales(playersinkbin))
+		g_object_set(playersinkbin->video_sink, "rectangle", playersinkbin->video_rectangle, NULL);
+
+	return TRUE;
+}
+
+static gboolean
+ensureAudioSink (GstPlayerSinkBin *playersinkbin)
+{
+	if (playersinkbin->m_aconvert)
+		return TRUE;
+
+	/* Create audio decoding pipeline factories */
+	playersinkbin->audio_sink = mediaConfMake(playersinkbin, "sink", "audio", ASINK, "player_asink");
+	playersinkbin->m_aconvert = gst_element_factory_make("audioconvert", "convert");
+	playersinkbin->m_resample = gst_element_factory_make("audioresample", "resample");
+	if (!playersinkbin->audio_sink || !playersinkbin->m_aconvert || !playersinkbin->m_resample)
+	{
+		if (!playersinkbin->audio_sink) GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate audio decoder (%s)\n", ASINK);
+		else gst_object_unref(playersinkbin->audio_sink);
+		if (!playersinkbin->m_aconvert) GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate audio m_aconvert \n");
+		else gst_object_unref(playersinkbin->m_aconvert);
+		if (!playersinkbin->m_resample) GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate audio m_resample \n");
+		else gst_object_unref(playersinkbin->m_resample);
+		playersinkbin->audio_sink = playersinkbin->m_aconvert = playersinkbin->m_resample = NULL;
+		return FALSE;
+	}
+
+	gst_bin_add_many(GST_BIN(playersinkbin), playersinkbin->m_aconvert,playersinkbin->m_resample,playersinkbin->audio_sink,NULL);
+	gst_util_set_object_arg(G_OBJECT(playersinkbin->audio_sink), "sync", "false");
+
+	if(!gst_element_link(playersinkbin->m_aconvert,playersinkbin->m_resample))
+	{
+		GST_ERROR_OBJECT(playersinkbin,"Failed to link m_aconvert to m_resample\n");
+		return FALSE;
+	}
+	if(!gst_element_link(playersinkbin->m_resample,playersinkbin->audio_sink))
+	{
+		GST_ERROR_OBJECT(playersinkbin,"Failed to link m_resample to audio_sink\n");
+		return FALSE;
+	}
+	gst_element_sync_state_with_parent(playersinkbin->m_aconvert);
+	gst_element_sync_state_with_parent(playersinkbin->m_resample);
+	gst_element_sync_state_with_parent(playersinkbin->audio_sink);
+#ifdef USE_GST1
+	watchSink(playersinkbin, playersinkbin->audio_sink);
+	if (playersinkbin->play_speed != DEFAULT_PLAY_SPEED && speedKeepsAudio(playersinkbin, playersinkbin->play_speed))
+		ensureTimeStretch(playersinkbin);
+
+	/* Audio description is mixed in ahead of the shared convert/resample */
+	if (playersinkbin->ad_pid)
+	{
+		playersinkbin->ad_mixer = gst_element_factory_make("audiomixer", "admix");
+		if (!playersinkbin->ad_mixer)
+		{
+			GST_WARNING_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate audiomixer\n");
+			return TRUE;
+		}
+		if (g_object_class_find_property(G_OBJECT_GET_CLASS(playersinkbin->ad_mixer), "start-time-selection"))
+			gst_util_set_object_arg(G_OBJECT(playersinkbin->ad_mixer), "start-time-selection", "first");
+		gst_bin_add(GST_BIN(playersinkbin), playersinkbin->ad_mixer);
+		playersinkbin->ad_main_pad = gst_element_get_request_pad(playersinkbin->ad_mixer, "sink_%u");
+		if (!playersinkbin->ad_main_pad || !gst_element_link(playersinkbin->ad_mixer, playersinkbin->m_aconvert))
+		{
+			GST_ERROR_OBJECT(playersinkbin,"Failed to link audio mixer\n");
+			if (playersinkbin->ad_main_pad)
+			{
+				gst_element_release_request_pad(playersinkbin->ad_mixer, playersinkbin->ad_main_pad);
+				gst_object_unref(playersinkbin->ad_main_pad);
+			}
+			gst_bin_remove(GST_BIN(playersinkbin), playersinkbin->ad_mixer);
+			playersinkbin->ad_mixer = NULL;
+			playersinkbin->ad_main_pad = NULL;
+			return TRUE;
+		}
+		gst_element_sync_state_with_parent(playersinkbin->ad_mixer);
+		if (!playersinkbin->ad_stall_id)
+		{
+			GstClock *clock = gst_system_clock_obtain();
+
+			GST_OBJECT_LOCK(playersinkbin);
+			playersinkbin->ad_stall_id = gst_clock_new_periodic_id(clock, gst_clock_get_time(clock) + AD_STALL_TIMEOUT,
+			    AD_STALL_TIMEOUT / 2);
+			gst_clock_id_wait_async(playersinkbin->ad_stall_id, adStallTick, playersinkbin, NULL);
+			GST_OBJECT_UNLOCK(playersinkbin);
+			gst_object_unref(clock);
+		}
+	}
+#endif
+
+	return TRUE;
+}
+
+static void
+writeAVStatus (const char *status)
+{
+	FILE* fp;
+
+	if(avstatus)
+	{
+		fp= fopen(AV_STATUS,"a");
+	}
+	else
+	{
+		fp= fopen(AV_STATUS,"w");
+		avstatus=1;
+	}
+	if(fp)
+	{
+		fwrite(status,1,strlen(status),fp);
+		fclose(fp);
+	}
+}
+
+/* First element of the shared video back-end, where input chains link to */
+static GstElement*
+videoSinkEntry (GstPlayerSinkBin *playersinkbin)
+{
+	if (playersinkbin->vrate)
+		return playersinkbin->vrate;
+	if (playersinkbin->m_vscalar)
+		return playersinkbin->m_vscalar;
+	return playersinkbin->vconvert ? playersinkbin->vconvert : playersinkbin->video_sink;
+}
+
+/* Width and height of a "x,y,w,h" rectangle, 0 for full screen */
+static void
+parseRectangle (const gchar *rectangle, guint *width, guint *height)
+{
+	gint x = 0, y = 0, w = 0, h = 0;
+
+	if (!rectangle || sscanf(rectangle, "%d,%d,%d,%d", &x, &y, &w, &h) != 4 || w <= 0 || h <= 0)
+		w = h = 0;
+	*width = w;
+	*height = h;
+}
+
+/* The platform sink places and scales the picture itself */
+static gboolean
+videoSinkScales (GstPlayerSinkBin *playersinkbin)
+{
+	return g_object_class_find_property(G_OBJECT_GET_CLASS(playersinkbin->video_sink), "rectangle") != NULL;
+}
+
+/* Output of the bin's own scaler: raw video at the rectangle size */
+static GstCaps*
+getScalerCaps (GstPlayerSinkBin *playersinkbin)
+{
+	GstCaps *caps;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	if (playersinkbin->rect_width)
+		caps = gst_caps_new_simple("video/x-raw", "width", G_TYPE_INT, (gint) playersinkbin->rect_width,
+		                           "height", G_TYPE_INT, (gint) playersinkbin->rect_height, NULL);
+	else
+		caps = gst_caps_new_empty_simple("video/x-raw");
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	return caps;
+}
+
+/* Reduced-resolution decode: libav decoders can output 1/2 or 1/4 size
+ * pictures ("lowres"), skipping most of the IDCT work and the memory traffic
+ * of full size frames. Chosen as small as still covers the rectangle. Only
+ * the DCT codecs implement it, libav silently decodes anything else, H.264
+ * and HEVC included, at full size. */
+static gboolean
+videoLowresSupported (GstCaps *caps)
+{
+	GstStructure *s = gst_caps_get_structure(caps, 0);
+
+	return gst_structure_has_name(s, "video/mpeg") || gst_structure_has_name(s, "image/jpeg");
+}
+
+static gint
+getVideoLowres (GstPlayerSinkBin *playersinkbin, gint width, gint height)
+{
+	gint lowres = 0;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	/* Half size at least for a picture-in-picture or without a decoder slot,
+	 * for the codecs that have it; H.264 and HEVC only get skip-frame and the
+	 * frame rate cap */
+	if ((playersinkbin->low_power || playersinkbin->video_degraded) && width >= 2 && height >= 2)
+		lowres = 1;
+	while (playersinkbin->rect_width && lowres < 2 && width > 0 && height > 0 &&
+	       (guint) (width >> (lowres + 1)) >= playersinkbin->rect_width &&
+	       (guint) (height >> (lowres + 1)) >= playersinkbin->rect_height)
+		lowres++;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	return lowres;
+}
+
+/* The platform sink decodes in hardware and takes the parsed ES directly. A
+ * sink that only takes raw video needs a software decoder in front of it.
+ * From a streaming thread the sink is running and linked and its state is
+ * left alone. */
+static gboolean
+videoSinkNeedsDecoder (GstPlayerSinkBin *playersinkbin, GstCaps *caps, gboolean streaming)
+{
+	GstPad *sink_pad;
+	GstCaps *sink_caps;
+	gboolean accepted;
+
+	/* Auto-plugging sinks only expose their real caps once in READY */
+	if (!streaming && GST_STATE(playersinkbin->video_sink) < GST_STATE_READY)
+		gst_element_set_state(playersinkbin->video_sink, GST_STATE_READY);
+
+	sink_pad = gst_element_get_static_pad(playersinkbin->video_sink, "sink");
+	sink_caps = gst_pad_query_caps(sink_pad, NULL);
+	accepted = gst_caps_can_intersect(caps, sink_caps);
+	GST_DEBUG_OBJECT(playersinkbin,"playersinkbin : video sink caps %" GST_PTR_FORMAT " %s compressed caps\n",
+	                 sink_caps, accepted ? "accept" : "do not accept");
+	gst_caps_unref(sink_caps);
+	gst_object_unref(sink_pad);
+
+	return !accepted;
+}
+
+static gboolean
+ensureVideoConvert (GstPlayerSinkBin *playersinkbin)
+{
+	GstPad *sink_pad;
+	gboolean linked;
+
+	if (playersinkbin->vconvert)
+		return TRUE;
+
+	playersinkbin->vconvert = gst_element_factory_make("videoconvert", "vconvert");
+	if (!playersinkbin->vconvert)
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate videoconvert\n");
+		return FALSE;
+	}
+	gst_bin_add(GST_BIN(playersinkbin), playersinkbin->vconvert);
+	/* With a hardware decoded chain on the sink, linkVideoOutput() switches */
+	sink_pad = gst_element_get_static_pad(playersinkbin->video_sink, "sink");
+	linked = gst_pad_is_linked(sink_pad);
+	gst_object_unref(sink_pad);
+	if (!linked && !gst_element_link(playersinkbin->vconvert, playersinkbin->video_sink))
+	{
+		GST_ERROR_OBJECT(playersinkbin,"Failed to link vconvert to video sink\n");
+		return FALSE;
+	}
+	gst_element_sync_state_with_parent(playersinkbin->vconvert);
+
+	/* A sink that cannot scale gets pictures at the rectangle size, scaled
+	 * before the conversion so that only the smaller picture is converted */
+	if (!videoSinkScales(playersinkbin))
+	{
+		playersinkbin->m_vscalar = gst_element_factory_make("videoscale", "vscale");
+		playersinkbin->m_vfilter = gst_element_factory_make("capsfilter", "vfilter");
+		if (!playersinkbin->m_vscalar || !playersinkbin->m_vfilter)
+		{
+			GST_WARNING_OBJECT(playersinkbin,"playersinkbin : no video scaler, pictures go out at decoded size\n");
+			if (playersinkbin->m_vscalar) gst_object_unref(playersinkbin->m_vscalar);
+			if (playersinkbin->m_vfilter) gst_object_unref(playersinkbin->m_vfilter);
+			playersinkbin->m_vscalar = playersinkbin->m_vfilter = NULL;
+			return TRUE;
+		}
+		playersinkbin->m_vcaps = getScalerCaps(playersinkbin);
+		g_object_set(playersinkbin->m_vfilter, "caps", playersinkbin->m_vcaps, NULL);
+		gst_bin_add_many(GST_BIN(playersinkbin), playersinkbin->m_vscalar, playersinkbin->m_vfilter, NULL);
+		if (!gst_element_link_many(playersinkbin->m_vscalar, playersinkbin->m_vfilter, playersinkbin->vconvert, NULL))
+		{
+			GST_ERROR_OBJECT(playersinkbin,"Failed to link video scaler to vconvert\n");
+			return FALSE;
+		}
+		gst_element_sync_state_with_parent(playersinkbin->m_vfilter);
+		gst_element_sync_state_with_parent(playersinkbin->m_vscalar);
+	}
+
+	/* Low-power instances drop pictures above their frame rate before any
+	 * scaling or conversion is spent on them */
+	if (playersinkbin->low_power)
+	{
+		playersinkbin->vrate = gst_element_factory_make("videorate", "vrate");
+		if (!playersinkbin->vrate)
+		{
+			GST_WARNING_OBJECT(playersinkbin,"playersinkbin : no videorate, low-power output is not rate capped\n");
+			return TRUE;
+		}
+		g_object_set(playersinkbin->vrate, "drop-only", TRUE, "max-rate", (gint) playersinkbin->low_power_framerate, NULL);
+		gst_bin_add(GST_BIN(playersinkbin), playersinkbin->vrate);
+		if (!gst_element_link(playersinkbin->vrate, playersinkbin->m_vscalar ? playersinkbin->m_vscalar : playersinkbin->vconvert))
+		{
+			GST_ERROR_OBJECT(playersinkbin,"Failed to link videorate\n");
+			return FALSE;
+		}
+		gst_element_sync_state_with_parent(playersinkbin->vrate);
+	}
+
+	return TRUE;
+}
+
+/* Link the active input's video output to the back-end: through the software
+ * chain when it carries decoded video, otherwise straight to the sink. Only
+ * one of the two feeds the sink at a time. */
+static gboolean
+linkVideoOutput (GstPlayerSinkBin *playersinkbin, GstPlayerSinkBinInput *input)
+{
+	gboolean software = (input->video_decoder != NULL);
+	GstPad *sink_pad = gst_element_get_static_pad(playersinkbin->video_sink, "sink");
+	GstPad *entry_pad;
+	GstPad *peer;
+	gboolean ret;
+
+	peer = gst_pad_get_peer(input->video_src);
+	if (peer)
+	{
+		gst_pad_unlink(input->video_src, peer);
+		gst_object_unref(peer);
+	}
+	if (playersinkbin->vconvert)
+	{
+		GstPad *convert_src = gst_element_get_static_pad(playersinkbin->vconvert, "src");
+
+		if (software && !gst_pad_is_linked(sink_pad))
+			gst_pad_link(convert_src, sink_pad);
+		else if (!software && gst_pad_is_linked(convert_src))
+			gst_pad_unlink(convert_src, sink_pad);
+		gst_object_unref(convert_src);
+	}
+	gst_object_unref(sink_pad);
+
+	entry_pad = gst_element_get_static_pad(software ? videoSinkEntry(playersinkbin) : playersinkbin->video_sink, "sink");
+	ret = GST_PAD_LINK_SUCCESSFUL(gst_pad_link(input->video_src, entry_pad));
+	gst_object_unref(entry_pad);
+
+	return ret;
+}
+
+/* Decoder arbitration.
+ * Hardware decoders, each feeding its own sink, are a few per device and shared
+ * by every playersinkbin of the process, main, PiP and prewarmed alike. They are
+ * handed out as slots, "video-decoders" of them ([resources] in media.conf), by
+ * "resource-priority": an instance taking the last slot from a lower priority
+ * one preempts it, and an instance left without a slot decodes in software at
+ * reduced cost (skip B-frames, and reduced resolution where the codec has it)
+ * instead of failing. A
+ * preempted instance keeps its slot until it has switched over, on its next
+ * buffer; only then does the slot go to the preempting instance, which decodes
+ * in software meanwhile. One waiting gets the hardware back when a slot frees
+ * up. With model=local every video decode takes
+ * a slot, so the arbitration can be exercised on a box without hardware
+ * decoders: the loser there is the reduced-cost decode. Sinks are not
+ * arbitrated: each instance is given its plane by "plane", and there is no
+ * software fallback for a sink left out.
+ */
+enum
+{
+	RESOURCE_NONE,
+	RESOURCE_WAITING,
+	RESOURCE_HELD,
+	RESOURCE_RELEASING /* preempted, held until its chain is rebuilt */
+};
+
+static GMutex resource_lock;
+static GList *resource_users; /* instances holding or waiting for a slot */
+
+static void
+postResourceMessage (GstPlayerSinkBin *playersinkbin, const gchar *reason)
+{
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : decoder slot %s\n", reason);
+	gst_element_post_message(GST_ELEMENT(playersinkbin),
+	    gst_message_new_element(GST_OBJECT(playersinkbin),
+	        gst_structure_new("playersinkbin-resource",
+	            "reason", G_TYPE_STRING, reason,
+	            "priority", G_TYPE_INT, playersinkbin->resource_priority, NULL)));
+}
+
+/* Under resource_lock: hand a free slot to the highest priority instance
+ * waiting, returned with a reference */
+static GstPlayerSinkBin*
+nextVideoSlotHolder (void)
+{
+	GstPlayerSinkBin *waiter = NULL;
+	GList *l;
+
+	for (l = resource_users; l; l = l->next) {
+		GstPlayerSinkBin *user = (GstPlayerSinkBin *) l->data;
+
+		if (user->resource_state == RESOURCE_WAITING &&
+		    (!waiter || user->resource_priority > waiter->resource_priority))
+			waiter = user;
+	}
+	if (waiter)
+	{
+		waiter->resource_state = RESOURCE_HELD;
+		gst_object_ref(waiter);
+	}
+
+	return waiter;
+}
+
+static void reconfigureVideo (GstPlayerSinkBin *playersinkbin);
+
+static void
+grantVideoSlot (GstPlayerSinkBin *waiter)
+{
+	if (!waiter)
+		return;
+	postResourceMessage(waiter, "granted");
+	reconfigureVideo(waiter);
+	gst_object_unref(waiter);
+}
+
+/* A preempted instance is done with the hardware once its chain runs without
+ * it: only now does its slot go to the next holder */
+static void
+videoSlotReleased (GstPlayerSinkBin *playersinkbin)
+{
+	GstPlayerSinkBin *waiter = NULL;
+
+	g_mutex_lock(&resource_lock);
+	if (playersinkbin->resource_state == RESOURCE_RELEASING)
+	{
+		playersinkbin->resource_state = RESOURCE_WAITING;
+		waiter = nextVideoSlotHolder();
+	}
+	g_mutex_unlock(&resource_lock);
+
+	grantVideoSlot(waiter);
+}
+
+#ifdef USE_GST1
+static gboolean swapVideoCodec (GstPlayerSinkBin *playersinkbin, GstPlayerSinkBinInput *input, GstCaps *caps,
+    const VideoCodec *codec);
+
+static GstPadProbeReturn
+videoSlotProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	const VideoCodec *codec;
+	GstCaps *caps;
+
+	GST_OBJECT_LOCK(input->owner);
+	input->video_slot_probe = 0;
+	caps = input->video_caps ? gst_caps_ref(input->video_caps) : NULL;
+	GST_OBJECT_UNLOCK(input->owner);
+	codec = caps ? getVideoCodec(caps) : NULL;
+	/* A successful swap releases a preempted slot, a failed one leaves the
+	 * chain on the hardware and the slot with it */
+	if (codec)
+		swapVideoCodec(input->owner, input, caps, codec);
+	else
+		videoSlotReleased(input->owner);
+	if (caps)
+		gst_caps_unref(caps);
+
+	return GST_PAD_PROBE_REMOVE;
+}
+#endif
+
+/* Rebuild the active video chain on its next buffer for a slot change. A
+ * preempted instance with no video chain to rebuild releases its slot right
+ * away. */
+static void
+reconfigureVideo (GstPlayerSinkBin *playersinkbin)
+{
+#ifdef USE_GST1
+	GstPlayerSinkBinInput *input;
+	GstPad *pad = NULL;
+	gboolean scheduled;
+
+	/* Called for other instances too, whose inputs change under their lock */
+	GST_OBJECT_LOCK(playersinkbin);
+	input = &playersinkbin->inputs[playersinkbin->active_input];
+	if (input->m_vqueue && input->video_parser && !input->video_slot_probe)
+	{
+		pad = gst_element_get_static_pad(input->m_vqueue, "src");
+		input->video_slot_probe = gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, videoSlotProbe, input, NULL);
+	}
+	scheduled = (input->video_slot_probe != 0);
+	GST_OBJECT_UNLOCK(playersinkbin);
+	if (pad)
+		gst_object_unref(pad);
+	if (!scheduled)
+		videoSlotReleased(playersinkbin);
+#else
+	videoSlotReleased(playersinkbin);
+#endif
+}
+
+/* TRUE when playersinkbin holds a slot, preempting a lower priority holder
+ * if none is free */
+static gboolean
+acquireVideoSlot (GstPlayerSinkBin *playersinkbin)
+{
+	GstPlayerSinkBinMediaConf *conf = mediaConfRef();
+	GstPlayerSinkBin *victim = NULL;
+	gboolean was_waiting;
+	guint held = 0;
+	GList *l;
+
+	g_mutex_lock(&resource_lock);
+	if (playersinkbin->resource_state == RESOURCE_HELD || playersinkbin->resource_state == RESOURCE_RELEASING)
+	{
+		/* Preempted: the chain being rebuilt goes to software */
+		gboolean held_now = (playersinkbin->resource_state == RESOURCE_HELD);
+
+		g_mutex_unlock(&resource_lock);
+		mediaConfUnref(conf);
+		return held_now;
+	}
+	was_waiting = (playersinkbin->resource_state == RESOURCE_WAITING);
+	for (l = resource_users; l; l = l->next) {
+		GstPlayerSinkBin *user = (GstPlayerSinkBin *) l->data;
+
+		if (user->resource_state != RESOURCE_HELD && user->resource_state != RESOURCE_RELEASING)
+			continue;
+		held++;
+		if (user->resource_state == RESOURCE_HELD &&
+		    user->resource_priority < playersinkbin->resource_priority &&
+		    (!victim || user->resource_priority < victim->resource_priority))
+			victim = user;
+	}
+	if (!was_waiting)
+		resource_users = g_list_prepend(resource_users, playersinkbin);
+
+	if (conf->video_decoders == 0 || held < conf->video_decoders)
+		victim = NULL;
+	else if (victim)
+	{
+		/* The slot is only handed over by videoSlotReleased() */
+		victim->resource_state = RESOURCE_RELEASING;
+		victim->resource_preemptions++;
+		gst_object_ref(victim);
+	}
+	playersinkbin->resource_state = (held < conf->video_decoders || conf->video_decoders == 0) ?
+	    RESOURCE_HELD : RESOURCE_WAITING;
+	g_mutex_unlock(&resource_lock);
+	mediaConfUnref(conf);
+
+	if (playersinkbin->resource_state == RESOURCE_WAITING && !was_waiting)
+		postResourceMessage(playersinkbin, victim ? "preempting" : "denied");
+	if (victim)
+	{
+		postResourceMessage(victim, "preempted");
+		reconfigureVideo(victim);
+		gst_object_unref(victim);
+	}
+
+	return playersinkbin->resource_state == RESOURCE_HELD;
+}
+
+/* Give the slot back, to the highest priority instance waiting for one */
+static void
+releaseVideoSlot (GstPlayerSinkBin *playersinkbin)
+{
+	GstPlayerSinkBin *waiter = NULL;
+
+	g_mutex_lock(&resource_lock);
+	resource_users = g_list_remove(resource_users, playersinkbin);
+	if (playersinkbin->resource_state == RESOURCE_HELD || playersinkbin->resource_state == RESOURCE_RELEASING)
+		waiter = nextVideoSlotHolder();
+	playersinkbin->resource_state = RESOURCE_NONE;
+	playersinkbin->video_degraded = FALSE;
+	g_mutex_unlock(&resource_lock);
+
+	grantVideoSlot(waiter);
+}
+
+/* Decode path of a video chain: software when the sink cannot take the
+ * stream, or when decoding in the sink needs a slot and none is left */
+static gboolean
+videoUseSoftwareDecode (GstPlayerSinkBin *playersinkbin, GstCaps *caps, gboolean streaming)
+{
+	gboolean needs_decoder = videoSinkNeedsDecoder(playersinkbin, caps, streaming);
+	gboolean needs_slot;
+	gboolean granted;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	needs_slot = !needs_decoder || playersinkbin->conf->resource_local;
+	GST_OBJECT_UNLOCK(playersinkbin);
+	granted = needs_slot ? acquireVideoSlot(playersinkbin) : TRUE;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	playersinkbin->video_degraded = !granted;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	return needs_decoder || !granted;
+}
+
+/* Follow a new rectangle: rescale to it. A software decoder only reads its
+ * reduced-resolution mode when it opens, and reopening it means flushing the
+ * chain on every resize, so the mode catches up at the decoder's next CAPS
+ * and the scaler covers the difference until then. */
+static void
+updateVideoScaling (GstPlayerSinkBin *playersinkbin)
+{
+	if (playersinkbin->m_vfilter)
+	{
+		GstCaps *caps = getScalerCaps(playersinkbin);
+
+		g_object_set(playersinkbin->m_vfilter, "caps", caps, NULL);
+		gst_caps_replace(&playersinkbin->m_vcaps, caps);
+		gst_caps_unref(caps);
+	}
+}
+
+/* Decoder threads: all cores not already kept busy by the rest of the
+ * system, unless set explicitly with "video-decoder-threads" */
+static gint
+getVideoDecoderThreads (GstPlayerSinkBin *playersinkbin)
+{
+	gint cores = g_get_num_processors();
+	gint threads;
+	double load = 0;
+	FILE *fp;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	threads = playersinkbin->video_decoder_threads;
+	GST_OBJECT_UNLOCK(playersinkbin);
+	if (threads > 0)
+		return threads;
+
+	fp = fopen(LOADAVG, "r");
+	if (fp)
+	{
+		if (fscanf(fp, "%lf", &load) != 1)
+			load = 0;
+		fclose(fp);
+	}
+	threads = cores - (gint)(load + 0.5);
+
+	return CLAMP(threads, 1, cores);
+}
+
+#ifdef USE_GST1
+static GstPadProbeReturn
+decodeInputProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+	guint slot;
+
+	if (!GST_BUFFER_PTS_IS_VALID(buffer))
+		return GST_PAD_PROBE_OK;
+
+	GST_OBJECT_LOCK(input->owner);
+	slot = input->decode_slot++ % PLAYERSINKBIN_DECODE_TIMING_SLOTS;
+	input->decode_pts[slot] = GST_BUFFER_PTS(buffer);
+	input->decode_start[slot] = gst_util_get_timestamp();
+	GST_OBJECT_UNLOCK(input->owner);
+
+	return GST_PAD_PROBE_OK;
+}
+
+/* Snapshots.
+ * The picture on screen is taken from the video sink's last sample when it
+ * keeps one holding a raw picture in system memory, so a still costs no
+ * decode. A decoding sink's sample is a compressed access unit and is never
+ * used. Otherwise the request waits for the
+ * next picture out of the software decoder, which is copied rather than kept
+ * so no buffer of the decoder's bounded pool stays pinned. The picture is
+ * wrapped in a GstSample and, when a size is requested, scaled by
+ * gst_video_convert_sample_async (videoscale, ORC/SIMD where available). The
+ * conversion is started from the event context so its callback, and
+ * "snapshot-ready", run there too.
+ */
+typedef struct _SnapshotRequest
+{
+	GstPlayerSinkBin *playersinkbin;
+	guint id;
+	GstSample *sample;
+	guint width;
+	guint height;
+} SnapshotRequest;
+
+static void
+freeSnapshotRequest (gpointer data)
+{
+	SnapshotRequest *request = (SnapshotRequest *) data;
+
+	if (request->sample)
+		gst_sample_unref(request->sample);
+	gst_object_unref(request->playersinkbin);
+	g_free(request);
+}
+
+static void
+snapshotReady (SnapshotRequest *request, GstSample *sample)
+{
+	g_signal_emit (G_OBJECT (request->playersinkbin), gst_player_sinkbin_signals[SIGNAL_SNAPSHOT_READY], 0,
+	               request->id, sample);
+}
+
+/* Takes the converted sample and the error */
+static void
+snapshotConverted (GstSample *sample, GError *error, gpointer data)
+{
+	SnapshotRequest *request = (SnapshotRequest *) data;
+
+	if (error)
+	{
+		GST_WARNING_OBJECT(request->playersinkbin,"playersinkbin : snapshot %u failed: %s\n", request->id, error->message);
+		g_error_free(error);
+	}
+	snapshotReady(request, error ? NULL : sample);
+	if (sample)
+		gst_sample_unref(sample);
+}
+
+static gboolean
+startSnapshot (gpointer data)
+{
+	SnapshotRequest *request = (SnapshotRequest *) data;
+	GstStructure *s = gst_caps_get_structure(gst_sample_get_caps(request->sample), 0);
+	gint width = 0, height = 0, par_n = 1, par_d = 1;
+	GstCaps *caps;
+
+	gst_structure_get_int(s, "width", &width);
+	gst_structure_get_int(s, "height", &height);
+	gst_structure_get_fraction(s, "pixel-aspect-ratio", &par_n, &par_d);
+
+	if ((request->width == 0 && request->height == 0) ||
+	    ((gint) request->width == width && (gint) request->height == height) ||
+	    width <= 0 || height <= 0 || par_n <= 0 || par_d <= 0)
+	{
+		snapshotReady(request, request->sample);
+		freeSnapshotRequest(request);
+		return FALSE;
+	}
+
+	/* Square pixels at the display aspect ratio for a missing dimension */
+	if (request->width == 0)
+		request->width = gst_util_uint64_scale_round(request->height, (guint64) width * par_n, (guint64) height * par_d);
+	else if (request->height == 0)
+		request->height = gst_util_uint64_scale_round(request->width, (guint64) height * par_d, (guint64) width * par_n);
+
+	caps = gst_caps_copy(gst_sample_get_caps(request->sample));
+	gst_caps_set_simple(caps, "width", G_TYPE_INT, MAX(request->width, 1), "height", G_TYPE_INT, MAX(request->height, 1),
+	                    "pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1, NULL);
+	gst_video_convert_sample_async(request->sample, caps, GST_SECOND, snapshotConverted, request, freeSnapshotRequest);
+	gst_caps_unref(caps);
+
+	return FALSE;
+}
+
+/* Only a raw picture in system memory can be handed out or scaled */
+static gboolean
+snapshotUsable (GstSample *sample)
+{
+	GstCaps *caps = gst_sample_get_caps(sample);
+	GstCapsFeatures *features;
+
+	if (!caps || gst_caps_is_empty(caps) || !gst_sample_get_buffer(sample) ||
+	    !gst_structure_has_name(gst_caps_get_structure(caps, 0), "video/x-raw"))
+		return FALSE;
+	features = gst_caps_get_features(caps, 0);
+
+	return !features || gst_caps_features_contains(features, GST_CAPS_FEATURE_MEMORY_SYSTEM_MEMORY);
+}
+
+static GstPadProbeReturn
+decodeOutputProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	GstPlayerSinkBin *playersinkbin = input->owner;
+	GstBuffer *buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+	GstClockTime now = gst_util_get_timestamp();
+	GList *pending = NULL;
+	GMainContext *context = NULL;
+	guint i;
+
+	GST_OBJECT_LOCK(input->owner);
+	if (playersinkbin->snapshot_pending && input == &playersinkbin->inputs[playersinkbin->active_input])
+	{
+		pending = playersinkbin->snapshot_pending;
+		playersinkbin->snapshot_pending = NULL;
+		context = g_main_context_ref(getEventContext(playersinkbin));
+	}
+	input->decoded_frames++;
+	for (i = 0; i < PLAYERSINKBIN_DECODE_TIMING_SLOTS && GST_BUFFER_PTS_IS_VALID(buffer); i++) {
+		if (input->decode_pts[i] == GST_BUFFER_PTS(buffer)) {
+			guint64 elapsed = now - input->decode_start[i];
+
+			input->decode_time += elapsed;
+			input->decode_time_max = MAX(input->decode_time_max, elapsed);
+			input->decode_pts[i] = GST_CLOCK_TIME_NONE;
+			break;
+		}
+	}
+	GST_OBJECT_UNLOCK(input->owner);
+
+	if (pending)
+	{
+		GstCaps *caps = gst_pad_get_current_caps(pad);
+		/* A copy: the decoder's pool is bounded and the conversion takes a while */
+		GstBuffer *copy = gst_buffer_copy_deep(buffer);
+		GstSample *sample = gst_sample_new(copy, caps, NULL, NULL);
+		GList *l;
+
+		for (l = pending; l; l = l->next) {
+			SnapshotRequest *request = (SnapshotRequest *) l->data;
+
+			request->sample = gst_sample_ref(sample);
+			g_main_context_invoke(context, startSnapshot, request);
+		}
+		gst_sample_unref(sample);
+		gst_buffer_unref(copy);
+		if (caps)
+			gst_caps_unref(caps);
+		g_list_free(pending);
+		g_main_context_unref(context);
+	}
+
+	return GST_PAD_PROBE_OK;
+}
+
+/* Apply the reduced-resolution mode for the coded size before the decoder
+ * opens with it */
+static GstPadProbeReturn
+lowresCapsProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+	gint width = 0, height = 0, lowres;
+	gboolean changed;
+	GstCaps *caps;
+
+	if (GST_EVENT_TYPE(event) != GST_EVENT_CAPS)
+		return GST_PAD_PROBE_OK;
+
+	gst_event_parse_caps(event, &caps);
+	if (videoLowresSupported(caps))
+	{
+		gst_structure_get_int(gst_caps_get_structure(caps, 0), "width", &width);
+		gst_structure_get_int(gst_caps_get_structure(caps, 0), "height", &height);
+	}
+	lowres = width ? getVideoLowres(input->owner, width, height) : 0;
+
+	GST_OBJECT_LOCK(input->owner);
+	changed = (lowres != input->lowres);
+	input->lowres = lowres;
+	GST_OBJECT_UNLOCK(input->owner);
+
+	if (changed)
+	{
+		GST_INFO_OBJECT(input->owner,"playersinkbin : decoding %dx%d at 1/%d size\n", width, height, 1 << lowres);
+		g_object_set(GST_PAD_PARENT(pad), "lowres", lowres, NULL);
+	}
+
+	return GST_PAD_PROBE_OK;
+}
+
+/* Deinterlacing.
+ * Software rendered interlaced video would show combing, so a deinterlacer is
+ * put behind the decoder while its output caps say interlaced (or mixed) and
+ * taken out again when they turn progressive. Both happen in the CAPS event
+ * probe on the decoder's src pad, before the event goes to the peer, so the
+ * stream is never stopped and progressive video has nothing in its path. The
+ * method is fixed for the stream: motion adaptive (greedyh) where the CPU
+ * allows, otherwise the constant cost linear interpolation.
+ */
+static void
+getDeinterlaceMethod (GstPlayerSinkBin *playersinkbin, gint height, gchar *method, gsize size)
+{
+	GST_OBJECT_LOCK(playersinkbin);
+	if (playersinkbin->deinterlace_method)
+		g_strlcpy(method, playersinkbin->deinterlace_method, size);
+	else if (playersinkbin->low_power || playersinkbin->video_degraded ||
+	         (height > 576 && g_get_num_processors() < 4))
+		g_strlcpy(method, "linear", size);
+	else
+		g_strlcpy(method, "greedyh", size);
+	GST_OBJECT_UNLOCK(playersinkbin);
+}
+
+static void
+insertDeinterlace (GstPlayerSinkBinInput *input, GstPad *decoder_pad, gint height)
+{
+	GstPlayerSinkBin *playersinkbin = input->owner;
+	GstElement *deinterlace = gst_element_factory_make("deinterlace", NULL);
+	gchar method[16];
+	GstPad *pad;
+
+	if (!deinterlace)
+	{
+		GST_WARNING_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate deinterlace, interlaced video shown as is\n");
+		return;
+	}
+	getDeinterlaceMethod(playersinkbin, height, method, sizeof(method));
+	gst_util_set_object_arg(G_OBJECT(deinterlace), "method", method);
+	gst_bin_add(GST_BIN(input->bin), deinterlace);
+	gst_element_sync_state_with_parent(deinterlace);
+
+	pad = gst_element_get_static_pad(deinterlace, "src");
+	gst_ghost_pad_set_target(GST_GHOST_PAD(input->video_src), pad);
+	gst_object_unref(pad);
+	pad = gst_element_get_static_pad(deinterlace, "sink");
+	if (!GST_PAD_LINK_SUCCESSFUL(gst_pad_link(decoder_pad, pad)))
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to link deinterlace\n");
+	gst_object_unref(pad);
+
+	GST_OBJECT_LOCK(playersinkbin);
+	input->video_deinterlace = deinterlace;
+	g_strlcpy(input->deinterlace_method, method, sizeof(input->deinterlace_method));
+	GST_OBJECT_UNLOCK(playersinkbin);
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : deinterlacing with %s\n", method);
+}
+
+static void
+removeDeinterlace (GstPlayerSinkBinInput *input, GstPad *decoder_pad)
+{
+	GstPlayerSinkBin *playersinkbin = input->owner;
+	GstElement *deinterlace = input->video_deinterlace;
+	GstPad *pad = gst_element_get_static_pad(deinterlace, "sink");
+
+	gst_pad_unlink(decoder_pad, pad);
+	gst_object_unref(pad);
+	gst_ghost_pad_set_target(GST_GHOST_PAD(input->video_src), decoder_pad);
+	GST_OBJECT_LOCK(playersinkbin);
+	input->video_deinterlace = NULL;
+	GST_OBJECT_UNLOCK(playersinkbin);
+	gst_element_set_state(deinterlace, GST_STATE_NULL);
+	gst_bin_remove(GST_BIN(input->bin), deinterlace);
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : progressive video, deinterlace removed\n");
+}
+
+static GstPadProbeReturn
+deinterlaceCapsProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+	const gchar *mode;
+	gboolean interlaced;
+	gboolean pending;
+	gint height = 0;
+	GstCaps *caps;
+
+	if (GST_EVENT_TYPE(event) != GST_EVENT_CAPS)
+		return GST_PAD_PROBE_OK;
+
+	gst_event_parse_caps(event, &caps);
+	mode = gst_structure_get_string(gst_caps_get_structure(caps, 0), "interlace-mode");
+	gst_structure_get_int(gst_caps_get_structure(caps, 0), "height", &height);
+	interlaced = (mode && strcmp(mode, "progressive"));
+
+	/* A chain waiting to replace another has no ghost pad of its own yet */
+	GST_OBJECT_LOCK(input->owner);
+	pending = (input->video_pending != NULL);
+	GST_OBJECT_UNLOCK(input->owner);
+	if (interlaced && !input->video_deinterlace && input->video_src && !pending)
+		insertDeinterlace(input, pad, height);
+	else if (!interlaced && input->video_deinterlace)
+		removeDeinterlace(input, pad);
+
+	return GST_PAD_PROBE_OK;
+}
+
+#endif
+
+static guint
+gst_player_sinkbin_snapshot (GstPlayerSinkBin *playersinkbin, guint width, guint height)
+{
+#ifdef USE_GST1
+	GstPlayerSinkBinInput *input;
+	SnapshotRequest *request;
+	GMainContext *context;
+	guint id;
+
+	GstSample *sample = NULL;
+
+	if (playersinkbin->video_sink && g_object_class_find_property(G_OBJECT_GET_CLASS(playersinkbin->video_sink), "last-sample"))
+		g_object_get(playersinkbin->video_sink, "last-sample", &sample, NULL);
+	if (sample && !snapshotUsable(sample))
+	{
+		gst_sample_unref(sample);
+		sample = NULL;
+	}
+
+	GST_OBJECT_LOCK(playersinkbin);
+	input = &playersinkbin->inputs[playersinkbin->active_input];
+	if (!sample && !input->video_decoder)
+	{
+		GST_OBJECT_UNLOCK(playersinkbin);
+		GST_WARNING_OBJECT(playersinkbin,"playersinkbin : no decoded picture to take a snapshot from\n");
+		return 0;
+	}
+	request = g_new0(SnapshotRequest, 1);
+	request->playersinkbin = gst_object_ref(playersinkbin);
+	request->sample = sample;
+	request->width = width;
+	request->height = height;
+	if (++playersinkbin->snapshot_id == 0)
+		++playersinkbin->snapshot_id;
+	id = request->id = playersinkbin->snapshot_id;
+	if (!sample)
+	{
+		/* Served by decodeOutputProbe */
+		playersinkbin->snapshot_pending = g_list_append(playersinkbin->snapshot_pending, request);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		return id;
+	}
+	context = g_main_context_ref(getEventContext(playersinkbin));
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	g_main_context_invoke(context, startSnapshot, request);
+	g_main_context_unref(context);
+
+	return id;
+#else
+	GST_WARNING_OBJECT(playersinkbin,"playersinkbin : snapshots need GStreamer 1.x\n");
+	return 0;
+#endif
+}
+
+static GstElement*
+createVideoDecoder (GstPlayerSinkBin *playersinkbin, GstPlayerSinkBinInput *input, const VideoCodec *codec)
+{
+	gchar *conf_name = mediaConfString(playersinkbin, "decoder", codec->conf_key);
+	const gchar *name = conf_name ? conf_name : codec->decoder;
+	GstElement *decoder;
+	guint i;
+
+	decoder = gst_element_factory_make(name, NULL);
+	if (!decoder)
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate video decoder (%s)\n", name);
+		g_free(conf_name);
+		return NULL;
+	}
+
+	input->decoder_threads = getVideoDecoderThreads(playersinkbin);
+	if (g_object_class_find_property(G_OBJECT_GET_CLASS(decoder), "max-threads"))
+		g_object_set(decoder, "max-threads", input->decoder_threads, NULL);
+	/* Low-power: skip the non-reference (B) pictures, libav mode 1 */
+	if ((playersinkbin->low_power || playersinkbin->video_degraded) && g_object_class_find_property(G_OBJECT_GET_CLASS(decoder), "skip-frame"))
+		g_object_set(decoder, "skip-frame", 1, NULL);
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : software video decode with %s, %d threads\n", name, input->decoder_threads);
+	g_free(conf_name);
+
+	for (i = 0; i < PLAYERSINKBIN_DECODE_TIMING_SLOTS; i++)
+		input->decode_pts[i] = GST_CLOCK_TIME_NONE;
+	input->lowres = 0;
+#ifdef USE_GST1
+	{
+		GstPad *pad = gst_element_get_static_pad(decoder, "sink");
+		gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, decodeInputProbe, input, NULL);
+		if (g_object_class_find_property(G_OBJECT_GET_CLASS(decoder), "lowres"))
+			gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, lowresCapsProbe, input, NULL);
+		gst_object_unref(pad);
+		pad = gst_element_get_static_pad(decoder, "src");
+		gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, decodeOutputProbe, input, NULL);
+		gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, deinterlaceCapsProbe, input, NULL);
+		gst_object_unref(pad);
+	}
+#endif
+
+	return decoder;
+}
+
+#ifdef USE_GST1
+/* Mid-stream codec change on the same PID, e.g. MPEG-2 ads in an H.264
+ * channel. The CAPS event is caught on the video queue's src pad, in the queue
+ * thread, so everything before it has already gone into the parser. The old
+ * parser/decoder is drained with an EOS that is dropped at the ghost pad,
+ * then replaced; the queue, ghost pad and sink stay as they are. The stream is
+ * held in the probe for the duration of the swap. */
+static gboolean
+swapVideoCodec (GstPlayerSinkBin *playersinkbin, GstPlayerSinkBinInput *input, GstCaps *caps,
+    const VideoCodec *codec)
+{
+	GstClockTime start = gst_util_get_timestamp();
+	GstElement *parser;
+	GstElement *decoder = NULL;
+	GstElement *last;
+	GstPad *pad;
+
+	parser = gst_element_factory_make(codec->parser, NULL);
+	if (videoUseSoftwareDecode(playersinkbin, caps, TRUE))
+	{
+		if (ensureVideoConvert(playersinkbin))
+			decoder = createVideoDecoder(playersinkbin, input, codec);
+		else
+			GST_WARNING_OBJECT(playersinkbin,"playersinkbin : sink does not take %" GST_PTR_FORMAT "\n", caps);
+	}
+	if (!parser)
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Cannot get %s parser from factory\n", codec->parser);
+		if (decoder)
+			gst_object_unref(decoder);
+		return FALSE;
+	}
+
+	/* Drain what the old elements still hold */
+	GST_OBJECT_LOCK(playersinkbin);
+	input->video_reconfiguring = TRUE;
+	GST_OBJECT_UNLOCK(playersinkbin);
+	pad = gst_element_get_static_pad(input->video_parser, "sink");
+	gst_pad_send_event(pad, gst_event_new_eos());
+	gst_object_unref(pad);
+	GST_OBJECT_LOCK(playersinkbin);
+	input->video_reconfiguring = FALSE;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	gst_element_unlink(input->m_vqueue, input->video_parser);
+	gst_element_set_state(input->video_parser, GST_STATE_NULL);
+	gst_bin_remove(GST_BIN(input->bin), input->video_parser);
+	if (input->video_decoder)
+	{
+		gst_element_set_state(input->video_decoder, GST_STATE_NULL);
+		gst_bin_remove(GST_BIN(input->bin), input->video_decoder);
+	}
+	if (input->video_deinterlace)
+	{
+		gst_element_set_state(input->video_deinterlace, GST_STATE_NULL);
+		gst_bin_remove(GST_BIN(input->bin), input->video_deinterlace);
+		GST_OBJECT_LOCK(playersinkbin);
+		input->video_deinterlace = NULL;
+		GST_OBJECT_UNLOCK(playersinkbin);
+	}
+
+	input->video_parser = parser;
+	input->video_decoder = decoder;
+	gst_bin_add(GST_BIN(input->bin), parser);
+	last = parser;
+	if (decoder)
+	{
+		gst_bin_add(GST_BIN(input->bin), decoder);
+		gst_element_link(parser, decoder);
+		last = decoder;
+	}
+	if (!gst_element_link(input->m_vqueue, parser))
+		GST_ERROR_OBJECT(playersinkbin,"Failed to link video parse\n");
+	pad = gst_element_get_static_pad(last, "src");
+	gst_ghost_pad_set_target(GST_GHOST_PAD(input->video_src), pad);
+	gst_object_unref(pad);
+	if (input == &playersinkbin->inputs[playersinkbin->active_input] && !linkVideoOutput(playersinkbin, input))
+		GST_ERROR_OBJECT(playersinkbin,"Failed to link video output\n");
+	if (isIndexedInput(playersinkbin, input))
+	{
+		pad = gst_element_get_static_pad(parser, "src");
+		gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+		    indexOutputProbe, input, NULL);
+		gst_object_unref(pad);
+	}
+	gst_element_sync_state_with_parent(parser);
+	if (decoder)
+		gst_element_sync_state_with_parent(decoder);
+	if (input == &playersinkbin->inputs[playersinkbin->active_input])
+		updateActiveInput(playersinkbin);
+
+	GST_OBJECT_LOCK(playersinkbin);
+	input->codec_changes++;
+	input->last_codec_change_latency = gst_util_get_timestamp() - start;
+	GST_OBJECT_UNLOCK(playersinkbin);
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : video codec changed to %s in %" GST_TIME_FORMAT "\n",
+	    codec->parser, GST_TIME_ARGS(input->last_codec_change_latency));
+	/* Preempted: the chain now runs without the hardware */
+	videoSlotReleased(playersinkbin);
+
+	return TRUE;
+}
+
+static GstPadProbeReturn
+videoCapsProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+	const VideoCodec *codec;
+	GstCaps *caps;
+
+	if (GST_EVENT_TYPE(event) != GST_EVENT_CAPS)
+		return GST_PAD_PROBE_OK;
+
+	gst_event_parse_caps(event, &caps);
+	if (sameStreamType(caps, input->video_caps))
+		return GST_PAD_PROBE_OK;
+
+	codec = getVideoCodec(caps);
+	if (!codec)
+	{
+		GST_ERROR_OBJECT(input->owner, "%" GST_PTR_FORMAT " parser not supported in playersinkbin", caps);
+		return GST_PAD_PROBE_OK;
+	}
+	/* The old caps stay on failure, so the next CAPS tries again */
+	if (swapVideoCodec(input->owner, input, caps, codec))
+	{
+		GST_OBJECT_LOCK(input->owner);
+		gst_caps_replace(&input->video_caps, caps);
+		GST_OBJECT_UNLOCK(input->owner);
+	}
+
+	return GST_PAD_PROBE_OK;
+}
+#endif
+
+/* Build queue ! parser [! decoder] inside the input and link it to the video
+ * back-end when the input is active */
+static void
+plugVideo (GstPlayerSinkBin *playersinkbin, GstPlayerSinkBinInput *input, GstPad *demux_src_pad,
+    GstCaps *caps, gboolean is_active)
+{
+	const gchar *padname = gst_structure_get_name(gst_caps_get_structure (caps, 0));
+	GstElement *last;
+	GstPad *sink_pad;
+	const VideoCodec *codec;
+	gboolean replacing;
+
+#ifdef USE_GST1
+	if (input->video_parser && isOrphaned(input, TRUE) &&
+	    plugStreamChange(playersinkbin, input, demux_src_pad, caps, TRUE))
+		return;
+	if (input->video_parser && waitDemuxPad(input, demux_src_pad, TRUE))
+		return;
+#endif
+	if (input->video_parser) {
+		GST_WARNING_OBJECT(playersinkbin, "video already plugged, ignoring %s", padname);
+		return;
+	}
+	codec = getVideoCodec(caps);
+	if(!codec) {
+		GST_ERROR_OBJECT(playersinkbin, "%s parser not supported in playersinkbin", padname);
+		return;
+	}
+	if (!ensureVideoSink(playersinkbin))
+	{
+		GST_ERROR_OBJECT(playersinkbin,"Cannot get %s sink from factory\n", padname);
+		return;
+	}
+
+	/******Creating the video decoding elements******/
+	/* Unnamed: a replacement chain may sit next to the one it replaces */
+	input->video_parser = gst_element_factory_make(codec->parser, NULL);
+	input->m_vqueue = gst_element_factory_make("queue", NULL);
+	if (input->m_vqueue)
+		mediaConfQueue(playersinkbin, input->m_vqueue, "video");
+	if (videoUseSoftwareDecode(playersinkbin, caps, FALSE) && ensureVideoConvert(playersinkbin))
+		input->video_decoder = createVideoDecoder(playersinkbin, input, codec);
+	if(input->video_parser==NULL || input->m_vqueue==NULL || (playersinkbin->vconvert && !input->video_decoder))
+	{
+		GST_ERROR_OBJECT(playersinkbin,"Cannot get %s parser from factory\n", padname);
+		if (input->video_parser) gst_object_unref(input->video_parser);
+		if (input->m_vqueue) gst_object_unref(input->m_vqueue);
+		if (input->video_decoder) gst_object_unref(input->video_decoder);
+		input->video_parser = input->m_vqueue = input->video_decoder = NULL;
+		return;
+	}
+
+	/*********linking the video elements********/
+	gst_bin_add_many(GST_BIN(input->bin), input->m_vqueue, input->video_parser, NULL);
+	last = input->video_parser;
+
+	if(!gst_element_link(input->m_vqueue,input->video_parser))
+	{
+		GST_ERROR_OBJECT(playersinkbin,"Failed to link video parse\n");
+		return;
+	}
+	if (input->video_decoder)
+	{
+		gst_bin_add(GST_BIN(input->bin), input->video_decoder);
+		if (!gst_element_link(input->video_parser, input->video_decoder))
+		{
+			GST_ERROR_OBJECT(playersinkbin,"Failed to link video parser & decoder\n");
+			return;
+		}
+		last = input->video_decoder;
+	}
+	GST_OBJECT_LOCK(playersinkbin);
+	replacing = (input->video_retired != NULL);
+	GST_OBJECT_UNLOCK(playersinkbin);
+#ifdef USE_GST1
+	input->video_src = setChainOutput(input, last, TRUE);
+#else
+	input->video_src = addInputOutput(input, last, "video_src");
+#endif
+	GST_OBJECT_LOCK(playersinkbin);
+	gst_caps_replace(&input->video_caps, caps);
+	GST_OBJECT_UNLOCK(playersinkbin);
+#ifdef USE_GST1
+	sink_pad = gst_element_get_static_pad(input->m_vqueue, "src");
+	gst_pad_add_probe(sink_pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, videoCapsProbe, input, NULL);
+	gst_object_unref(sink_pad);
+	if (isIndexedInput(playersinkbin, input))
+	{
+		guint i;
+
+		GST_OBJECT_LOCK(playersinkbin);
+		for (i = 0; i < PLAYERSINKBIN_INDEX_PENDING_SLOTS; i++)
+			input->index_pts[i] = GST_CLOCK_TIME_NONE;
+		gst_segment_init(&playersinkbin->keyframe_index_segment, GST_FORMAT_TIME);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		sink_pad = gst_element_get_static_pad(input->m_vqueue, "sink");
+		gst_pad_add_probe(sink_pad, GST_PAD_PROBE_TYPE_BUFFER, indexInputProbe, input, NULL);
+		gst_object_unref(sink_pad);
+		sink_pad = gst_element_get_static_pad(input->video_parser, "src");
+		gst_pad_add_probe(sink_pad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+		    indexOutputProbe, input, NULL);
+		gst_object_unref(sink_pad);
+	}
+#endif
+
+	if (is_active && !replacing && !linkVideoOutput(playersinkbin, input))
+	{
+		GST_ERROR_OBJECT(playersinkbin,"Failed to link video parser & sink\n");
+		return;
+	}
+
+#ifdef USE_GST1
+	if (!linkDemuxPad(input, demux_src_pad, input->m_vqueue))
+#else
+	sink_pad = gst_element_get_static_pad(input->m_vqueue, "sink");
+	if (!GST_PAD_LINK_SUCCESSFUL(gst_pad_link(demux_src_pad, sink_pad)))
+#endif
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to connect video pad");
+#ifndef USE_GST1
+		gst_object_unref(sink_pad);
+#endif
+		return;
+	}
+	else if (is_active && !replacing)
+	{
+		// Send the VideoCallback event
+		postEvent (playersinkbin, GSTPLAYERSINKBIN_EVENT_HAVE_VIDEO);
+	}
+	gst_element_sync_state_with_parent(input->m_vqueue);
+	gst_element_sync_state_with_parent(input->video_parser);
+	if (input->video_decoder)
+		gst_element_sync_state_with_parent(input->video_decoder);
+	if (is_active)
+	{
+		gst_element_sync_state_with_parent(playersinkbin->video_sink);
+		updateActiveInput(playersinkbin);
+		writeAVStatus("Video:SUCCESS\n");
+	}
+#ifndef USE_GST1
+	gst_object_unref(sink_pad);
+#endif
+}
+
+/* Audio is off in media.conf and for low-power instances */
+static gboolean
+audioEnabled (GstPlayerSinkBin *playersinkbin)
+{
+	gboolean enabled;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	enabled = playersinkbin->conf->audio_enable && !playersinkbin->low_power;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	return enabled;
+}
+
+/* Parser and decoder for an audio ES, NULL when it is not supported */
+static GstElement*
+createAudioDecoder (GstPlayerSinkBin *playersinkbin, GstCaps *caps, GstElement **parser)
+{
+	const gchar *media = gst_structure_get_name(gst_caps_get_structure(caps, 0));
+	GstElement *decoder = NULL;
+	gboolean omx;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	omx = playersinkbin->conf->omx;
+	GST_OBJECT_UNLOCK(playersinkbin);
+	*parser = NULL;
+	if (g_strrstr(media, "ac3"))
+	{
+		*parser = gst_element_factory_make("ac3parse", NULL);
+		decoder = mediaConfMake(playersinkbin, "decoder", "ac3", omx ? "avdec_ac3" : AC3_DEC, NULL);
+	}
+	else if (g_strrstr(media, "mpeg"))
+	{
+		const GValue* value = gst_structure_get_value(gst_caps_get_structure (caps, 0), "mpegversion");
+
+		GST_INFO("mpeg version %d", g_value_get_int(value));
+		if (g_value_get_int(value) == 1)
+		{
+			printf("mp3 playback=============\n");
+			*parser = gst_element_factory_make("mpegaudioparse", NULL);
+			decoder = mediaConfMake(playersinkbin, "decoder", "mp3", omx ? "mpg123audiodec" : MP3_DEC, NULL);
+		}
+		else
+		{
+			printf("aac playback...........\n");
+			*parser = gst_element_factory_make("aacparse", NULL);
+			decoder = mediaConfMake(playersinkbin, "decoder", "aac", omx ? "faad" : AC3_DEC, NULL);
+		}
+	}
+	else
+	{
+		GST_DEBUG_OBJECT(playersinkbin,"playersinkbin unsupported audio type\n");
+	}
+
+	return decoder;
+}
+
+/* Element the main audio output links to and its pad */
+static GstElement*
+audioSinkEntry (GstPlayerSinkBin *playersinkbin)
+{
+	return playersinkbin->ad_mixer ? playersinkbin->ad_mixer : playersinkbin->m_aconvert;
+}
+
+static GstPad*
+getEntryPad (GstPlayerSinkBin *playersinkbin, GstElement *entry)
+{
+	if (entry && entry == playersinkbin->ad_mixer)
+		return gst_object_ref(playersinkbin->ad_main_pad);
+	return gst_element_get_static_pad(entry, "sink");
+}
+
+#ifdef USE_GST1
+/* Audio description.
+ * The AD track of "ad-pid" gets a chain of its own next to the main audio;
+ * both decoders feed an audiomixer in front of the shared convert/resample
+ * stage, whose ORC mixing kernels are vectorized. The mono AD only has a
+ * converter of its own for the panner. The fade and pan the broadcaster wants
+ * travel in the AD descriptor of each AD PES header, which the demuxer drops:
+ * the TS going into the demuxer is scanned for them and every descriptor is
+ * matched to the buffer of its PES, in order, when that leaves the demuxer,
+ * then applied when the decoded AD with that timestamp goes into the mixer.
+ * Fade attenuates the main audio, pan places the AD in the stereo image.
+ * The mixer waits for data on all of its pads, so the AD pad is only linked
+ * while AD flows: the first decoded AD buffer links it, and a periodic check
+ * releases it once no AD came for AD_STALL_TIMEOUT, so a gap in the AD PID or
+ * a slow AD decoder never holds back the main audio.
+ */
+static void
+adPushControl (GstPlayerSinkBinInput *input, const GstPlayerSinkBinAdControl *control)
+{
+	GST_OBJECT_LOCK(input->owner);
+	if (input->ad_count == PLAYERSINKBIN_AD_CONTROL_SLOTS)
+	{
+		input->ad_first = (input->ad_first + 1) % PLAYERSINKBIN_AD_CONTROL_SLOTS;
+		input->ad_count--;
+	}
+	input->ad_controls[(input->ad_first + input->ad_count) % PLAYERSINKBIN_AD_CONTROL_SLOTS] = *control;
+	input->ad_count++;
+	if (control->valid)
+		input->ad_descriptors++;
+	GST_OBJECT_UNLOCK(input->owner);
+}
+
+/* PES header at the start of an AD packet's payload */
+static void
+adParsePes (GstPlayerSinkBinInput *input, const guint8 *data, guint size)
+{
+	GstPlayerSinkBinAdControl control = { FALSE, GST_CLOCK_TIME_NONE, FALSE, 0, 0 };
+	guint end;
+	guint pos = 9;
+	guint8 flags;
+
+	if (size < 9 || data[0] || data[1] || data[2] != 1)
+		return;
+	flags = data[7];
+	end = MIN(9 + data[8], size);
+	if (flags & 0x80)
+		pos += 5;  /* PTS */
+	if ((flags & 0xc0) == 0xc0)
+		pos += 5;  /* DTS */
+	if (flags & 0x20)
+		pos += 6;  /* ESCR */
+	if (flags & 0x10)
+		pos += 3;  /* ES rate */
+	if (flags & 0x08)
+		pos += 1;  /* trick mode */
+	if (flags & 0x04)
+		pos += 1;  /* copy info */
+	if (flags & 0x02)
+		pos += 2;  /* CRC */
+	/* PES extension with PES_private_data holding the AD descriptor */
+	if ((flags & 0x01) && pos < end && (data[pos] & 0x80) && pos + 17 <= end &&
+	    !memcmp(data + pos + 2, "DTGAD", 5))
+	{
+		control.valid = TRUE;
+		control.fade = data[pos + 8];
+		control.pan = data[pos + 9];
+	}
+	adPushControl(input, &control);
+}
+
+static void
+adScanBuffer (GstPlayerSinkBinInput *input, GstBuffer *buffer, guint pid)
+{
+	GstMapInfo map;
+	gsize pos = 0;
+
+	if (!gst_buffer_map(buffer, &map, GST_MAP_READ))
+		return;
+	/* Packets straddling buffers are missed, the descriptor comes with every PES */
+	while (pos + 188 <= map.size) {
+		const guint8 *packet = map.data + pos;
+		guint header = 4;
+
+		if (packet[0] != 0x47 || (pos + 376 <= map.size && packet[188] != 0x47))
+		{
+			pos++;
+			continue;
+		}
+		if ((packet[1] & 0x40) && (((packet[1] & 0x1f) << 8) | packet[2]) == pid)
+		{
+			if (packet[3] & 0x20)
+				header += 1 + packet[4];
+			if ((packet[3] & 0x10) && header < 188)
+				adParsePes(input, packet + header, 188 - header);
+		}
+		pos += 188;
+	}
+	gst_buffer_unmap(buffer, &map);
+}
+
+static gboolean
+adScanListItem (GstBuffer **buffer, guint idx, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+
+	adScanBuffer(input, *buffer, input->owner->ad_pid);
+	return TRUE;
+}
+
+/* TS going into the demuxer */
+static GstPadProbeReturn
+adScanProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+
+	if (info->type & GST_PAD_PROBE_TYPE_BUFFER_LIST)
+		gst_buffer_list_foreach(GST_PAD_PROBE_INFO_BUFFER_LIST(info), adScanListItem, input);
+	else
+		adScanBuffer(input, GST_PAD_PROBE_INFO_BUFFER(info), input->owner->ad_pid);
+
+	return GST_PAD_PROBE_OK;
+}
+
+/* AD buffer leaving the demuxer: the oldest unmatched PES is its own */
+static GstPadProbeReturn
+adDemuxProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	GstBuffer *buffer;
+	guint i;
+
+	/* Controls queued before a seek belong to PES that were flushed */
+	if (info->type & GST_PAD_PROBE_TYPE_EVENT_FLUSH)
+	{
+		if (GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info)) == GST_EVENT_FLUSH_STOP)
+		{
+			GST_OBJECT_LOCK(input->owner);
+			input->ad_first = input->ad_count = 0;
+			GST_OBJECT_UNLOCK(input->owner);
+		}
+		return GST_PAD_PROBE_OK;
+	}
+
+	buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+
+	GST_OBJECT_LOCK(input->owner);
+	for (i = 0; i < input->ad_count; i++) {
+		GstPlayerSinkBinAdControl *control = &input->ad_controls[(input->ad_first + i) % PLAYERSINKBIN_AD_CONTROL_SLOTS];
+
+		if (!control->demuxed)
+		{
+			control->demuxed = TRUE;
+			control->pts = GST_BUFFER_PTS(buffer);
+			break;
+		}
+	}
+	GST_OBJECT_UNLOCK(input->owner);
+
+	return GST_PAD_PROBE_OK;
+}
+
+/* Decoded AD going to the mixer: apply what was sent up to its timestamp */
+static GstPadProbeReturn
+adApplyProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	GstPlayerSinkBin *playersinkbin = input->owner;
+	GstClockTime pts = GST_BUFFER_PTS(GST_PAD_PROBE_INFO_BUFFER(info));
+	gboolean changed = FALSE;
+	guint8 fade;
+	guint8 pan;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	while (input->ad_count) {
+		GstPlayerSinkBinAdControl *control = &input->ad_controls[input->ad_first];
+
+		if (!control->demuxed || (GST_CLOCK_TIME_IS_VALID(pts) && GST_CLOCK_TIME_IS_VALID(control->pts) && control->pts > pts))
+			break;
+		if (control->valid && (control->fade != input->ad_fade || control->pan != input->ad_pan_byte))
+		{
+			input->ad_fade = control->fade;
+			input->ad_pan_byte = control->pan;
+			changed = TRUE;
+		}
+		input->ad_first = (input->ad_first + 1) % PLAYERSINKBIN_AD_CONTROL_SLOTS;
+		input->ad_count--;
+	}
+	fade = input->ad_fade;
+	pan = input->ad_pan_byte;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	if (changed)
+	{
+		/* 0.3 dB steps, 0xff mutes; pan 0 is centre, 64 right, 192 left */
+		gdouble volume = (fade == 0xff) ? 0.0 : pow(10.0, -0.3 * fade / 20.0);
+
+		if (playersinkbin->ad_main_pad)
+			g_object_set(playersinkbin->ad_main_pad, "volume", volume, NULL);
+		if (input->ad_pan)
+			g_object_set(input->ad_pan, "panorama", (gfloat) sin(pan * 2.0 * G_PI / 256.0), NULL);
+		GST_DEBUG_OBJECT(playersinkbin,"playersinkbin : audio description fade 0x%02x pan 0x%02x\n", fade, pan);
+	}
+
+	return GST_PAD_PROBE_OK;
+}
+
+static GstPadProbeReturn
+adReleaseProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN(data);
+	GstPad *peer = gst_pad_get_peer(pad);
+
+	if (peer)
+	{
+		gst_pad_unlink(pad, peer);
+		if (playersinkbin->ad_mixer)
+			gst_element_release_request_pad(playersinkbin->ad_mixer, peer);
+		gst_object_unref(peer);
+	}
+
+	return GST_PAD_PROBE_REMOVE;
+}
+
+/* Move the mixer's AD input over from one input to another, either NULL.
+ * An input whose AD is not flowing is linked by adFlowProbe later on. */
+static void
+linkAdOutput (GstPlayerSinkBin *playersinkbin, GstPlayerSinkBinInput *from, GstPlayerSinkBinInput *to)
+{
+	GstClockTime last = GST_CLOCK_TIME_NONE;
+	GstPad *pad;
+
+	if (from && from->ad_src && gst_pad_is_linked(from->ad_src))
+		gst_pad_add_probe(from->ad_src, GST_PAD_PROBE_TYPE_IDLE, adReleaseProbe, playersinkbin, NULL);
+	if (!to || !to->ad_src || !playersinkbin->ad_mixer || gst_pad_is_linked(to->ad_src))
+		return;
+	GST_OBJECT_LOCK(playersinkbin);
+	last = to->ad_last_buffer;
+	GST_OBJECT_UNLOCK(playersinkbin);
+	if (!GST_CLOCK_TIME_IS_VALID(last) || gst_util_get_timestamp() - last > AD_STALL_TIMEOUT)
+		return;
+	pad = gst_element_get_request_pad(playersinkbin->ad_mixer, "sink_%u");
+	if (!pad || !GST_PAD_LINK_SUCCESSFUL(gst_pad_link(to->ad_src, pad)))
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to link audio description to the mixer\n");
+	if (pad)
+		gst_object_unref(pad);
+}
+
+/* Decoded AD leaving the input: linked to the mixer while it flows and is
+ * the active input's, dropped otherwise so its queue keeps running */
+static GstPadProbeReturn
+adFlowProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	GstPlayerSinkBin *playersinkbin = input->owner;
+	gboolean is_active;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	input->ad_last_buffer = gst_util_get_timestamp();
+	is_active = (input == &playersinkbin->inputs[playersinkbin->active_input]) && !input->ad_detaching;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	if (!is_active || !playersinkbin->ad_mixer)
+		return GST_PAD_PROBE_DROP;
+	if (!gst_pad_is_linked(input->ad_src))
+	{
+		GST_DEBUG_OBJECT(playersinkbin,"playersinkbin : audio description flowing, mixing it in\n");
+		linkAdOutput(playersinkbin, NULL, input);
+	}
+
+	return gst_pad_is_linked(input->ad_src) ? GST_PAD_PROBE_OK : GST_PAD_PROBE_DROP;
+}
+
+static void
+adDetach (GstElement *element, gpointer data)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN(element);
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : audio description stalled, main audio plays alone\n");
+	linkAdOutput(playersinkbin, input, NULL);
+	/* Undo the fade; the next descriptor applies again once AD is back */
+	if (playersinkbin->ad_main_pad)
+		g_object_set(playersinkbin->ad_main_pad, "volume", 1.0, NULL);
+	GST_OBJECT_LOCK(playersinkbin);
+	input->ad_fade = input->ad_pan_byte = 0;
+	input->ad_detaching = FALSE;
+	GST_OBJECT_UNLOCK(playersinkbin);
+}
+
+static gboolean
+adStallTick (GstClock *clock, GstClockTime time, GstClockID id, gpointer data)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN(data);
+	GstPlayerSinkBinInput *input;
+	gboolean stalled;
+
+	if (!tickEnter(playersinkbin, &playersinkbin->ad_stall_id, id, &playersinkbin->ad_stall_thread))
+		return TRUE;
+	GST_OBJECT_LOCK(playersinkbin);
+	input = &playersinkbin->inputs[playersinkbin->active_input];
+	stalled = input->ad_src && !input->ad_detaching && GST_CLOCK_TIME_IS_VALID(input->ad_last_buffer) &&
+	    gst_util_get_timestamp() - input->ad_last_buffer > AD_STALL_TIMEOUT;
+	if (stalled)
+		input->ad_detaching = TRUE;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	if (stalled && gst_pad_is_linked(input->ad_src))
+		gst_element_call_async(GST_ELEMENT(playersinkbin), adDetach, input, NULL);
+	else if (stalled)
+	{
+		GST_OBJECT_LOCK(playersinkbin);
+		input->ad_detaching = FALSE;
+		GST_OBJECT_UNLOCK(playersinkbin);
+	}
+	tickLeave(playersinkbin, &playersinkbin->ad_stall_thread);
+
+	return TRUE;
+}
+
+static gboolean
+isAdPad (GstPlayerSinkBin *playersinkbin, GstPad *demux_src_pad)
+{
+	gchar *name;
+	gchar *suffix;
+	gboolean ret;
+
+	if (!playersinkbin->ad_pid)
+		return FALSE;
+	name = gst_pad_get_name(demux_src_pad);
+	suffix = g_strdup_printf("_%04x", playersinkbin->ad_pid);
+	ret = g_str_has_suffix(name, suffix);
+	g_free(suffix);
+	g_free(name);
+
+	return ret;
+}
+
+static void
+plugAudioDescription (GstPlayerSinkBin *playersinkbin, GstPlayerSinkBinInput *input, GstPad *demux_src_pad,
+    GstCaps *caps, gboolean is_active)
+{
+	GstPad *pad;
+
+	if (input->ad_src || !input->demux)
+		return;
+	if (is_active && !ensureAudioSink(playersinkbin))
+		return;
+	if (!playersinkbin->ad_mixer)
+	{
+		GST_WARNING_OBJECT(playersinkbin,"playersinkbin : no audio mixer, audio description not played\n");
+		return;
+	}
+
+	input->ad_decoder = createAudioDecoder(playersinkbin, caps, &input->ad_parser);
+	input->ad_queue = gst_element_factory_make("queue", NULL);
+	input->ad_convert = gst_element_factory_make("audioconvert", NULL);
+	input->ad_pan = gst_element_factory_make("audiopanorama", NULL);
+	if (!input->ad_decoder || !input->ad_parser || !input->ad_queue || !input->ad_convert || !input->ad_pan)
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate audio description chain\n");
+		if (input->ad_decoder) gst_object_unref(input->ad_decoder);
+		if (input->ad_parser) gst_object_unref(input->ad_parser);
+		if (input->ad_queue) gst_object_unref(input->ad_queue);
+		if (input->ad_convert) gst_object_unref(input->ad_convert);
+		if (input->ad_pan) gst_object_unref(input->ad_pan);
+		input->ad_decoder = input->ad_parser = input->ad_queue = input->ad_convert = input->ad_pan = NULL;
+		return;
+	}
+	mediaConfQueue(playersinkbin, input->ad_queue, "audio");
+	gst_bin_add_many(GST_BIN(input->bin), input->ad_queue, input->ad_parser, input->ad_decoder,
+	                 input->ad_convert, input->ad_pan, NULL);
+	if (!gst_element_link_many(input->ad_queue, input->ad_parser, input->ad_decoder,
+	                           input->ad_convert, input->ad_pan, NULL))
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to link audio description chain\n");
+	input->ad_src = addInputOutput(input, input->ad_pan, "ad_src");
+
+	GST_OBJECT_LOCK(playersinkbin);
+	input->ad_first = input->ad_count = 0;
+	input->ad_fade = input->ad_pan_byte = 0;
+	input->ad_last_buffer = GST_CLOCK_TIME_NONE;
+	input->ad_detaching = FALSE;
+	GST_OBJECT_UNLOCK(playersinkbin);
+	pad = gst_element_get_static_pad(input->demux, "sink");
+	input->ad_scan_probe = gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST,
+	    adScanProbe, input, NULL);
+	gst_object_unref(pad);
+	gst_pad_add_probe(demux_src_pad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_FLUSH, adDemuxProbe, input, NULL);
+	pad = gst_element_get_static_pad(input->ad_decoder, "src");
+	gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, adApplyProbe, input, NULL);
+	gst_object_unref(pad);
+	/* Linked to the mixer from here once decoded AD flows */
+	pad = gst_element_get_static_pad(input->ad_pan, "src");
+	gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, adFlowProbe, input, NULL);
+	gst_object_unref(pad);
+
+	pad = gst_element_get_static_pad(input->ad_queue, "sink");
+	if (!GST_PAD_LINK_SUCCESSFUL(gst_pad_link(demux_src_pad, pad)))
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to connect audio description pad\n");
+	gst_object_unref(pad);
+
+	gst_element_sync_state_with_parent(input->ad_pan);
+	gst_element_sync_state_with_parent(input->ad_convert);
+	gst_element_sync_state_with_parent(input->ad_decoder);
+	gst_element_sync_state_with_parent(input->ad_parser);
+	gst_element_sync_state_with_parent(input->ad_queue);
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : mixing audio description PID 0x%x\n", playersinkbin->ad_pid);
+}
+#endif
+
+/* SOC CHANGES: Dynamic call back from demux element to link audio and video source pads to downstream decode elements
+ * For video, identify the video encoder type(h264/mpeg) and link appropriate decoder element if soc has differenti
+ * elements for h264 and mpeg.
+ * For audio, link the audio pad containing the preferred language if multiple audio language streams are present.
+ * Chains are built inside the input the pad belongs to and only linked to the sinks when that input is active.
+ */
+static void
+plug_pad (GstPlayerSinkBin * playersinkbin, GstPad * demux_src_pad)
+{
+	GstPlayerSinkBinInput *input;
+	GstCaps* caps;
+	const gchar *padname;
+	gchar *pad1;
+	gboolean is_active;
+#ifdef USE_GST1
+	caps = gst_pad_get_current_caps(demux_src_pad);
+#else
+	caps =  gst_pad_get_caps(demux_src_pad);
+#endif
+	padname = gst_structure_get_name(gst_caps_get_structure (caps, 0));
+	pad1 = gst_pad_get_name (demux_src_pad);
           
 	GST_DEBUG_OBJECT(playersinkbin,"playersinkbin : plugging: padname: %s, pad1: %s\n",padname,pad1);
 	g_free (pad1);
+
+	input = getInputForPad(playersinkbin, demux_src_pad);
+	if (!input)
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : pad does not belong to any input\n");
+		gst_caps_unref (caps);
+		return;
+	}
+	is_active = (input == &playersinkbin->inputs[playersinkbin->active_input]);
+
 	if(g_strrstr(padname,"video"))
 	{
-                index = getVideoParserIndex(padname); 
-               if(index == -1 || index > MAX_VPARSER) {
-                        GST_ERROR_OBJECT(playersinkbin, "%s parser not supported in playersinkbin", padname);
-                        return;
-                } 
-                playersinkbin->video_parser = gst_element_factory_make(V_PARSER[index], "video-parser");
-                if(playersinkbin->video_parser==NULL)
+		plugVideo(playersinkbin, input, demux_src_pad, caps, is_active);
+	}
+
+	else if (g_strrstr(padname,"audio"))
+	{
+	if(audioEnabled(playersinkbin)){
+#ifdef USE_GST1
+          if (isAdPad(playersinkbin, demux_src_pad)) {
+                plugAudioDescription(playersinkbin, input, demux_src_pad, caps, is_active);
+                gst_caps_unref (caps);
+                return;
+          }
+          if (input->audio_linked && isOrphaned(input, FALSE) &&
+              plugStreamChange(playersinkbin, input, demux_src_pad, caps, FALSE)) {
+                gst_caps_unref (caps);
+                return;
+          }
+          if (input->audio_linked && waitDemuxPad(input, demux_src_pad, FALSE)) {
+                gst_caps_unref (caps);
+                return;
+          }
+#endif
+          if(!input->audio_linked) {
+          gboolean replacing;
+
+		GST_OBJECT_LOCK(playersinkbin);
+		replacing = (input->audio_retired != NULL);
+		GST_OBJECT_UNLOCK(playersinkbin);
+
+		input->m_adec = createAudioDecoder(playersinkbin, caps, &input->m_audio_parser);
+        input->m_aqueue = gst_element_factory_make("queue", NULL);
+		if (input->m_aqueue)
+			mediaConfQueue(playersinkbin, input->m_aqueue, "audio");
+		if(!input->m_adec || !input->m_audio_parser || !input->m_aqueue)
 		{
-			GST_ERROR_OBJECT(playersinkbin,"Cannot get %s parser from factory\n", padname);
+			GST_ERROR_OBJECT(playersinkbin,"Audio decoder is failed...........\n");
+			if (input->m_adec) gst_object_unref(input->m_adec);
+			if (input->m_audio_parser) gst_object_unref(input->m_audio_parser);
+			if (input->m_aqueue) gst_object_unref(input->m_aqueue);
+			input->m_adec = input->m_audio_parser = input->m_aqueue = NULL;
+			gst_caps_unref (caps);
 			return;
 		}
-               /******Creating the video decoding elements******/
-                playersinkbin->video_sink = gst_element_factory_make(VSINK, "player_vsink");
-                playersinkbin->m_vqueue = gst_element_factory_make("queue", "vqueue");
-                if(playersinkbin->video_sink==NULL)
-                {
-                        GST_ERROR_OBJECT(playersinkbin,"Cannot get %s sink from factory\n", padname);
-                        return;
-                }
-
-        if (!playersinkbin->m_vqueue || !playersinkbin->video_sink)
+        if (is_active && !ensureAudioSink(playersinkbin))
         {
-            if (!playersinkbin->video_sink) GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate video sink (%s)\n", VSINK);
-            if (!playersinkbin->m_vqueue) GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate vqueue \n");
+                gst_caps_unref (caps);
                 return;
         }
-               /*********linking the video elements********/
-                gst_bin_add_many(GST_BIN(playersinkbin), playersinkbin->demux,playersinkbin->m_vqueue,NULL);
-
-                gst_bin_add_many(GST_BIN(playersinkbin),playersinkbin->video_parser,playersinkbin->video_sink,NULL);	
 
+        gst_bin_add_many(GST_BIN(input->bin), input->m_aqueue, input->m_audio_parser, input->m_adec, NULL);
 
-		if(!gst_element_link(playersinkbin->video_parser, playersinkbin->video_sink))
-		{
-			GST_ERROR_OBJECT(playersinkbin,"Failed to link video parser & sink\n");
-			return;
-		}
-
-                if(!gst_element_link(playersinkbin->m_vqueue,playersinkbin->video_parser))
+           /******** Linking audio elements**********/
+	if(!gst_element_link(input->m_aqueue, input->m_audio_parser))
+                 {
+                        GST_ERROR_OBJECT(playersinkbin,"Failed to link m_aqueue to audio_parser\n");
+                        gst_caps_unref (caps);
+                        return;
+                }
+		if(!gst_element_link(input->m_audio_parser, input->m_adec))
                 {
-                        GST_ERROR_OBJECT(playersinkbin,"Failed to link video parse\n");
+                        GST_ERROR_OBJECT(playersinkbin,"Failed to link m_audio_parser to m_adec\n");
+                        gst_caps_unref (caps);
                         return;
                 }
-
-		GstPad* sink_pad = gst_element_get_static_pad(playersinkbin->m_vqueue, "sink");
-		if (!GST_PAD_LINK_SUCCESSFUL(gst_pad_link(demux_src_pad, sink_pad)))
+#ifdef USE_GST1
+		input->audio_src = setChainOutput(input, input->m_adec, FALSE);
+#else
+		input->audio_src = addInputOutput(input, input->m_adec, "audio_src");
+#endif
+		gst_caps_replace(&input->audio_caps, caps);
+		if (is_active && !replacing)
 		{
-			GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to connect video pad");
-			gst_caps_unref (caps);
-			return;
+			GstPad* convert_pad = getEntryPad(playersinkbin, audioSinkEntry(playersinkbin));
+			if (!GST_PAD_LINK_SUCCESSFUL(gst_pad_link(input->audio_src, convert_pad)))
+			{
+				GST_ERROR_OBJECT(playersinkbin,"Failed to link m_adec to m_aconvert\n");
+				gst_object_unref(convert_pad);
+				gst_caps_unref (caps);
+				return;
+			}
+			gst_object_unref(convert_pad);
 		}
-		else
+#ifdef USE_GST1
+		if (!linkDemuxPad(input, demux_src_pad, input->m_aqueue))
+			GST_ERROR_OBJECT(playersinkbin, "Failed to connect audio pad");
+#else
+		 GstPad* sink_pad = gst_element_get_static_pad(input->m_aqueue, "sink");
+		if (!GST_PAD_LINK_SUCCESSFUL(gst_pad_link(demux_src_pad, sink_pad)))
+			GST_ERROR_OBJECT(playersinkbin, "Failed to connect audio pad");
+         gst_object_unref(sink_pad);
+#endif
+
+	 gst_element_sync_state_with_parent(input->m_aqueue);
+	 gst_element_sync_state_with_parent(input->m_audio_parser);
+	 gst_element_sync_state_with_parent(input->m_adec);
+  		input->audio_linked=TRUE;
+		if (is_active)
 		{
-			// Send the VideoCallback event
-			g_signal_emit (G_OBJECT (playersinkbin), gst_player_sinkbin_signals[SIGNAL_PLAYERSINKBIN], 0,
-			               GSTPLAYERSINKBIN_EVENT_HAVE_VIDEO);
+			updateActiveInput(playersinkbin);
+			writeAVStatus("Audio:SUCCESS");
 		}
-                gst_element_sync_state_with_parent(playersinkbin->m_vqueue);
-		gst_element_sync_state_with_parent(playersinkbin->video_parser);
-		gst_element_sync_state_with_parent(playersinkbin->video_sink);
-                gst_element_sync_state_with_parent(playersinkbin->demux);
-                gst_object_unref(sink_pad);
-                if(avstatus)
+         }
+        }
+	}
+
+	gst_caps_unref (caps);
+}
+
+#ifdef USE_GST1
+/* Mosaic.
+ * One input, so one ingest path and one clock, feeds several programs of the
+ * multiplex to their own tiles. A TS parser reads the PSI once and splits the
+ * packets by program; behind each of its program pads a demuxer only handles
+ * the PES of that program and a queue starts the tile's own thread for parse,
+ * decode and render. Tiles are video only and laid out as a grid over the
+ * rectangle; a sink that cannot place the picture gets it scaled to the tile.
+ * The CPU time of each tile thread is accounted in the stats.
+ */
+static GstPadProbeReturn
+tileCpuProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinTile *tile = (GstPlayerSinkBinTile *) data;
+	struct timespec ts;
+	gint64 now;
+
+	/* Thread time between two buffers is what the previous one cost downstream */
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	now = (gint64) ts.tv_sec * GST_SECOND + ts.tv_nsec;
+	GST_OBJECT_LOCK(tile->owner);
+	if (tile->cpu_thread == g_thread_self() && now > tile->cpu_last)
+		tile->cpu_time += now - tile->cpu_last;
+	tile->cpu_thread = g_thread_self();
+	tile->cpu_last = now;
+	tile->buffers++;
+	GST_OBJECT_UNLOCK(tile->owner);
+
+	return GST_PAD_PROBE_OK;
+}
+
+static void
+plugTile (GstPlayerSinkBinTile *tile, GstPad *demux_src_pad)
+{
+	GstPlayerSinkBin *playersinkbin = tile->owner;
+	GstPlayerSinkBinInput *input = &playersinkbin->inputs[0];
+	GstCaps *caps = gst_pad_get_current_caps(demux_src_pad);
+	const VideoCodec *codec = caps ? getVideoCodec(caps) : NULL;
+	GstElement *last;
+	GstPad *pad;
+	GstCaps *sink_caps;
+	gboolean scales;
+	guint width, height;
+
+	if (!codec)
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : tile %d: unsupported video %" GST_PTR_FORMAT "\n", tile->program, caps);
+		if (caps)
+			gst_caps_unref(caps);
+		return;
+	}
+
+	tile->queue = gst_element_factory_make("queue", NULL);
+	tile->parser = gst_element_factory_make(codec->parser, NULL);
+	tile->sink = mediaConfMake(playersinkbin, "sink", "video", VSINK, NULL);
+	if (!tile->sink)
+		tile->sink = gst_element_factory_make(VSINK_FALLBACK, NULL);
+	if (!tile->queue || !tile->parser || !tile->sink)
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : tile %d: Failed to instantiate video chain\n", tile->program);
+		goto fail;
+	}
+	mediaConfQueue(playersinkbin, tile->queue, "video");
+
+	/* Same decode path choice as the main video, against the tile's sink */
+	gst_element_set_state(tile->sink, GST_STATE_READY);
+	pad = gst_element_get_static_pad(tile->sink, "sink");
+	sink_caps = gst_pad_query_caps(pad, NULL);
+	gst_object_unref(pad);
+	scales = g_object_class_find_property(G_OBJECT_GET_CLASS(tile->sink), "rectangle") != NULL;
+	if (!gst_caps_can_intersect(caps, sink_caps))
+	{
+		gchar *conf_name = mediaConfString(playersinkbin, "decoder", codec->conf_key);
+
+		tile->decoder = gst_element_factory_make(conf_name ? conf_name : codec->decoder, NULL);
+		g_free(conf_name);
+		tile->convert = gst_element_factory_make("videoconvert", NULL);
+		if (!tile->decoder || !tile->convert)
 		{
-			FILE* fp= fopen(AV_STATUS,"a");
-	                fwrite(" Video:SUCCESS",1,13,fp);
-			fwrite("\n",1,1,fp);
-        	        fclose(fp);
+			GST_ERROR_OBJECT(playersinkbin,"playersinkbin : tile %d: Failed to instantiate video decoder\n", tile->program);
+			gst_caps_unref(sink_caps);
+			goto fail;
 		}
-		else
+		/* Tiles already decode in parallel, one thread each; half size covers
+		 * any tile of a grid, for the codecs that can decode at half size */
+		if (g_object_class_find_property(G_OBJECT_GET_CLASS(tile->decoder), "max-threads"))
+			g_object_set(tile->decoder, "max-threads", 1, NULL);
+		if (playersinkbin->n_tiles > 1 && videoLowresSupported(caps) &&
+		    g_object_class_find_property(G_OBJECT_GET_CLASS(tile->decoder), "lowres"))
+			g_object_set(tile->decoder, "lowres", 1, NULL);
+		if (!scales)
 		{
-			FILE* fp= fopen(AV_STATUS,"w");
-			fwrite("Video:SUCCESS",1,13,fp);
-			fwrite("\n",1,1,fp);
-			avstatus=1;
-			fclose(fp);
+			parseRectangle(tile->rectangle, &width, &height);
+			tile->scale = gst_element_factory_make("videoscale", NULL);
+			tile->filter = gst_element_factory_make("capsfilter", NULL);
+			if (tile->scale && tile->filter)
+			{
+				GstCaps *filter_caps = gst_caps_new_simple("video/x-raw", "width", G_TYPE_INT, (gint) width,
+				                                           "height", G_TYPE_INT, (gint) height, NULL);
+				g_object_set(tile->filter, "caps", filter_caps, NULL);
+				gst_caps_unref(filter_caps);
+			}
+			else
+			{
+				if (tile->scale)
+					gst_object_unref(tile->scale);
+				if (tile->filter)
+					gst_object_unref(tile->filter);
+				tile->scale = tile->filter = NULL;
+			}
 		}
-
 	}
-
-	else if (g_strrstr(padname,"audio"))
+	gst_caps_unref(sink_caps);
+	if (scales)
+		g_object_set(tile->sink, "rectangle", tile->rectangle, NULL);
+
+	gst_bin_add_many(GST_BIN(input->bin), tile->queue, tile->parser, tile->sink, NULL);
+	gst_element_link(tile->queue, tile->parser);
+	last = tile->parser;
+	if (tile->decoder)
+	{
+		gst_bin_add_many(GST_BIN(input->bin), tile->decoder, tile->convert, NULL);
+		gst_element_link_many(last, tile->decoder, tile->convert, NULL);
+		last = tile->convert;
+	}
+	if (tile->scale)
+	{
+		gst_bin_add_many(GST_BIN(input->bin), tile->scale, tile->filter, NULL);
+		gst_element_link_many(last, tile->scale, tile->filter, NULL);
+		last = tile->filter;
+	}
+	if (!gst_element_link(last, tile->sink))
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : tile %d: Failed to link video sink\n", tile->program);
+
+	pad = gst_element_get_static_pad(tile->queue, "src");
+	gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, tileCpuProbe, tile, NULL);
+	gst_object_unref(pad);
+	pad = gst_element_get_static_pad(tile->queue, "sink");
+	if (!GST_PAD_LINK_SUCCESSFUL(gst_pad_link(demux_src_pad, pad)))
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : tile %d: Failed to connect video pad\n", tile->program);
+	gst_object_unref(pad);
+
+	gst_element_sync_state_with_parent(tile->sink);
+	if (tile->filter)
+		gst_element_sync_state_with_parent(tile->filter);
+	if (tile->scale)
+		gst_element_sync_state_with_parent(tile->scale);
+	if (tile->convert)
+		gst_element_sync_state_with_parent(tile->convert);
+	if (tile->decoder)
+		gst_element_sync_state_with_parent(tile->decoder);
+	gst_element_sync_state_with_parent(tile->parser);
+	gst_element_sync_state_with_parent(tile->queue);
+	tile->plugged = TRUE;
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : tile %d at %s, %s decode\n", tile->program, tile->rectangle,
+	                tile->decoder ? "software" : "sink");
+	gst_caps_unref(caps);
+	return;
+
+fail:
+	if (tile->queue)
+		gst_object_unref(tile->queue);
+	if (tile->parser)
+		gst_object_unref(tile->parser);
+	if (tile->decoder)
+		gst_object_unref(tile->decoder);
+	if (tile->convert)
+		gst_object_unref(tile->convert);
+	if (tile->sink)
 	{
-	if(Audio_Enable){
-          if(!audio_flag) {
+		gst_element_set_state(tile->sink, GST_STATE_NULL);
+		gst_object_unref(tile->sink);
+	}
+	tile->queue = tile->parser = tile->decoder = tile->convert = tile->sink = NULL;
+	gst_caps_unref(caps);
+}
 
-		if(g_strrstr(padname,"ac3"))
-		{
-			playersinkbin->m_audio_parser = gst_element_factory_make("ac3parse", NULL);
+static GstPadProbeReturn
+tileSegmentProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinTile *tile = (GstPlayerSinkBinTile *) data;
 
-			if(OMX_Enable){
-				playersinkbin->m_adec = gst_element_factory_make("avdec_ac3", "adec");
-			}
-			else{
+	/* Plugged once the caps are known, like the main demuxer pads */
+	if (GST_EVENT_TYPE(GST_PAD_PROBE_INFO_EVENT(info)) != GST_EVENT_SEGMENT)
+		return GST_PAD_PROBE_OK;
+	if (!tile->plugged)
+		plugTile(tile, pad);
 
-				playersinkbin->m_adec = gst_element_factory_make(AC3_DEC, "adec");
-			}
-	        }
-	        else if(g_strrstr(padname, "mpeg")) 
+	return GST_PAD_PROBE_REMOVE;
+}
+
+static void
+onTilePadAdded (GstElement *element, GstPad *demux_src_pad, gpointer data)
+{
+	GstPlayerSinkBinTile *tile = (GstPlayerSinkBinTile *) data;
+	gchar *padname = gst_pad_get_name(demux_src_pad);
+
+	/* Tiles are video only; the other pads stay unlinked */
+	if (g_str_has_prefix(padname, "video") && !tile->plugged)
+		gst_pad_add_probe(demux_src_pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM, tileSegmentProbe, tile, NULL);
+	g_free(padname);
+}
+
+/* Put the TS parser and the tiles' demuxers behind the input typefind */
+static gboolean
+createMosaic (GstPlayerSinkBinInput *input, GstPad *src_pad)
+{
+	GstPlayerSinkBin *playersinkbin = input->owner;
+	gchar **programs;
+	gint numbers[PLAYERSINKBIN_MAX_TILES];
+	GstPad *sink_pad;
+	gint x = 0, y = 0, w = 0, h = 0;
+	guint cols, rows;
+	guint i, n = 0;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	programs = g_strsplit(playersinkbin->mosaic_programs, ",", -1);
+	if (sscanf(playersinkbin->video_rectangle, "%d,%d,%d,%d", &x, &y, &w, &h) != 4 || w <= 0 || h <= 0)
+	{
+		x = y = 0;
+		w = MOSAIC_SCREEN_WIDTH;
+		h = MOSAIC_SCREEN_HEIGHT;
+	}
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	for (i = 0; programs[i] && n < PLAYERSINKBIN_MAX_TILES; i++) {
+		gchar *end = NULL;
+		guint64 number = g_ascii_strtoull(g_strstrip(programs[i]), &end, 10);
+
+		/* Program 0 is the network information, not a service */
+		if (end == programs[i] || *end != '\0' || number == 0 || number > G_MAXUINT16)
 		{
-                   const GValue* value = gst_structure_get_value(gst_caps_get_structure (caps, 0), "mpegversion");
-                   GST_INFO("mpeg version %d", g_value_get_int(value));
-                   switch ( g_value_get_int ( value ) ) 
-		   {
-                   case 1:
-                         printf("mp3 playback=============\n");
-                        playersinkbin->m_audio_parser = gst_element_factory_make("mpegaudioparse", NULL);
-
-                        if(OMX_Enable)
-                        {
-                                playersinkbin->m_adec = gst_element_factory_make("mpg123audiodec", "adec");
-                        }
-                        else {
-                                playersinkbin->m_adec = gst_element_factory_make(MP3_DEC, "adec");
-                        }
-                        break;
-                   default:
-                        printf("aac playback...........\n");
-                        playersinkbin->m_audio_parser = gst_element_factory_make("aacparse", NULL);
-
-                        if(OMX_Enable){
-                                playersinkbin->m_adec = gst_element_factory_make("faad", "adec");
-                        }
-                        else{
-
-                                playersinkbin->m_adec = gst_element_factory_make(AC3_DEC, "adec");
-                        }
-                        break;
-
-                   }
-                }
-                else
-            	{
- 		GST_DEBUG_OBJECT(playersinkbin,"playersinkbin unsupported audio type\n");	
+			GST_WARNING_OBJECT(playersinkbin,"playersinkbin : invalid mosaic program \"%s\", skipped\n", programs[i]);
+			continue;
 		}
-		if(!playersinkbin->m_adec)
+		numbers[n++] = (gint) number;
+	}
+	g_strfreev(programs);
+	if (!n)
+		return FALSE;
+	input->demux = gst_element_factory_make("tsparse", "player_tsparse");
+	if (!input->demux)
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate TS parser, mosaic disabled\n");
+		return FALSE;
+	}
+	gst_bin_add(GST_BIN(input->bin), input->demux);
+	sink_pad = gst_element_get_static_pad(input->demux, "sink");
+	if (!GST_PAD_LINK_SUCCESSFUL(gst_pad_link(src_pad, sink_pad)))
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to link typefind to TS parser\n");
+	gst_object_unref(sink_pad);
+
+	/* Smallest grid holding every tile, filled row by row */
+	for (cols = 1; cols * cols < n; cols++)
+		;
+	rows = (n + cols - 1) / cols;
+	playersinkbin->n_tiles = n;
+	for (i = 0; i < n; i++) {
+		GstPlayerSinkBinTile *tile = &playersinkbin->tiles[i];
+		gchar *name;
+
+		memset(tile, 0, sizeof(*tile));
+		tile->owner = playersinkbin;
+		tile->program = numbers[i];
+		g_snprintf(tile->rectangle, sizeof(tile->rectangle), "%d,%d,%d,%d",
+		           x + (gint) (i % cols) * (w / (gint) cols), y + (gint) (i / cols) * (h / (gint) rows),
+		           w / (gint) cols, h / (gint) rows);
+
+		name = g_strdup_printf("program_%d", tile->program);
+		tile->parse_pad = gst_element_get_request_pad(input->demux, name);
+		g_free(name);
+		tile->demux = gst_element_factory_make(DEMUX, NULL);
+		if (!tile->parse_pad || !tile->demux)
 		{
-			GST_ERROR_OBJECT(playersinkbin,"Audio decoder is failed...........\n");
+			GST_ERROR_OBJECT(playersinkbin,"playersinkbin : tile %d: Failed to set up program\n", tile->program);
+			if (tile->parse_pad)
+			{
+				gst_element_release_request_pad(input->demux, tile->parse_pad);
+				gst_object_unref(tile->parse_pad);
+			}
+			if (tile->demux)
+				gst_object_unref(tile->demux);
+			tile->parse_pad = NULL;
+			tile->demux = NULL;
+			continue;
 		}
-            /* Create audio decoding pipeline factories */
-        playersinkbin->audio_sink = gst_element_factory_make(ASINK, "player_asink");
-        playersinkbin->m_aqueue = gst_element_factory_make("queue", "aqueue");
-        playersinkbin->m_aconvert = gst_element_factory_make("audioconvert", "convert");
-        playersinkbin->m_resample = gst_element_factory_make("audioresample", "resample");
-        if (!playersinkbin->audio_sink || !playersinkbin->m_aqueue || !playersinkbin->m_aconvert || !playersinkbin->m_resample)
-        {
-                if (!playersinkbin->audio_sink) GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate audio decoder (%s)\n", ASINK);
-                if (!playersinkbin->m_aqueue) GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate audio m_aqueue \n");
-            if (!playersinkbin->m_aconvert) GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate audio m_aconvert \n");
-                if (!playersinkbin->m_resample) GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to instantiate audio m_resample \n");
-                return;
-        }
+		if (g_object_class_find_property(G_OBJECT_GET_CLASS(tile->demux), "program-number"))
+			g_object_set(tile->demux, "program-number", tile->program, NULL);
+		g_signal_connect(tile->demux, "pad-added", G_CALLBACK (onTilePadAdded), tile);
+		gst_bin_add(GST_BIN(input->bin), tile->demux);
+		sink_pad = gst_element_get_static_pad(tile->demux, "sink");
+		if (!GST_PAD_LINK_SUCCESSFUL(gst_pad_link(tile->parse_pad, sink_pad)))
+			GST_ERROR_OBJECT(playersinkbin,"playersinkbin : tile %d: Failed to link program pad\n", tile->program);
+		gst_object_unref(sink_pad);
+		gst_element_sync_state_with_parent(tile->demux);
+	}
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : mosaic of %u programs, %ux%u grid\n", n, cols, rows);
 
-        if (Audio_Enable) {
-        gst_bin_add_many(GST_BIN(playersinkbin), playersinkbin->m_aqueue,playersinkbin->m_aconvert,playersinkbin->m_resample,playersinkbin->audio_sink,NULL);
+	gst_element_sync_state_with_parent(input->demux);
+	return TRUE;
 }
 
-       	gst_bin_add(GST_BIN(playersinkbin), playersinkbin->m_audio_parser);
-	gst_bin_add(GST_BIN(playersinkbin), playersinkbin->m_adec);
-        gst_util_set_object_arg(G_OBJECT(playersinkbin->audio_sink), "sync", "false");
+typedef struct _OutputSwap
+{
+	GstPlayerSinkBinInput *from;
+	GstPlayerSinkBinInput *to;
+	gboolean is_video;
+} OutputSwap;
 
-           /******** Linking audio elements**********/
-	if(!gst_element_link(playersinkbin->m_aqueue, playersinkbin->m_audio_parser))
-                 {
-                        GST_ERROR_OBJECT(playersinkbin,"Failed to link m_aqueue to audio_parser\n");
-                        return;
-                }
-		if(!gst_element_link(playersinkbin->m_audio_parser, playersinkbin->m_adec))
-                {
-                        GST_ERROR_OBJECT(playersinkbin,"Failed to link m_audio_parser to m_adec\n");
-                        return;
-                }
-		if(!gst_element_link(playersinkbin->m_adec,playersinkbin->m_aconvert))
-                {
-                        GST_ERROR_OBJECT(playersinkbin,"Failed to link m_adec to m_aconvert\n");
-                        return;
-                }
-                if(!gst_element_link(playersinkbin->m_aconvert,playersinkbin->m_resample))
-                {
-                     GST_ERROR_OBJECT(playersinkbin,"Failed to link m_aconvert to m_resample\n");
-                        return;
-                }
-                 if(!gst_element_link(playersinkbin->m_resample,playersinkbin->audio_sink))
-                {
-                       GST_ERROR_OBJECT(playersinkbin,"Failed to link m_resample to audio_sink\n");
-                        return;
-                }
-		 GstPad* sink_pad = gst_element_get_static_pad(playersinkbin->m_aqueue, "sink");
-		if (!GST_PAD_LINK_SUCCESSFUL(gst_pad_link(demux_src_pad, sink_pad)))
-			GST_ERROR_OBJECT(playersinkbin, "Failed to connect audio pad");
+static void
+relinkOutput (OutputSwap *swap, GstPad *sink_pad)
+{
+	GstPlayerSinkBin *playersinkbin = swap->to->owner;
+	GstPad *to_pad = swap->is_video ? swap->to->video_src : swap->to->audio_src;
 
-	 gst_element_sync_state_with_parent(playersinkbin->m_aqueue);
-	 gst_element_sync_state_with_parent(playersinkbin->m_audio_parser);
-	 gst_element_sync_state_with_parent(playersinkbin->m_adec);
-         gst_element_sync_state_with_parent(playersinkbin->m_aconvert);
-         gst_element_sync_state_with_parent(playersinkbin->m_resample);
-	 gst_element_sync_state_with_parent(playersinkbin->audio_sink);	 
-         gst_object_unref(sink_pad);
-  		audio_flag=1;
-		if(avstatus)
+	if (swap->from)
+	{
+		GstPad *from_pad = swap->is_video ? swap->from->video_src : swap->from->audio_src;
+
+		if (from_pad)
+			gst_pad_unlink(from_pad, sink_pad);
+		GST_OBJECT_LOCK(playersinkbin);
+		if (swap->is_video)
+			swap->from->video_gate_open = FALSE;
+		else
+			swap->from->audio_gate_open = FALSE;
+		GST_OBJECT_UNLOCK(playersinkbin);
+	}
+
+	if (!to_pad)
+		return;
+	if (!GST_PAD_LINK_SUCCESSFUL(gst_pad_link(to_pad, sink_pad)))
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to link standby %s output\n", swap->is_video ? "video" : "audio");
+		return;
+	}
+	GST_OBJECT_LOCK(playersinkbin);
+	if (swap->is_video)
+		swap->to->video_gate_open = TRUE;
+	else
+		swap->to->audio_gate_open = TRUE;
+	GST_OBJECT_UNLOCK(playersinkbin);
+}
+
+static GstPadProbeReturn
+relinkOutputProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPad *sink_pad = gst_pad_get_peer(pad);
+
+	if (sink_pad) {
+		relinkOutput((OutputSwap *) data, sink_pad);
+		gst_object_unref(sink_pad);
+	}
+
+	return GST_PAD_PROBE_REMOVE;
+}
+
+/* Move one sink over from the active to the standby input. The unlink happens
+ * from an idle probe so that no buffer is in flight on the old output. */
+static void
+swapOutput (GstPlayerSinkBin *playersinkbin, GstPlayerSinkBinInput *from,
+    GstPlayerSinkBinInput *to, GstElement *sink, gboolean is_video)
+{
+	GstPad *from_pad = is_video ? from->video_src : from->audio_src;
+	OutputSwap *swap;
+
+	if (!sink)
+		return;
+
+	swap = g_new0(OutputSwap, 1);
+	swap->from = from;
+	swap->to = to;
+	swap->is_video = is_video;
+
+	if (from_pad && gst_pad_is_linked(from_pad)) {
+		gst_pad_add_probe(from_pad, GST_PAD_PROBE_TYPE_IDLE, relinkOutputProbe, swap, g_free);
+	} else {
+		GstPad *sink_pad = getEntryPad(playersinkbin, sink);
+		relinkOutput(swap, sink_pad);
+		gst_object_unref(sink_pad);
+		g_free(swap);
+	}
+}
+#endif
+
+static gboolean
+gst_player_sinkbin_swap_standby (GstPlayerSinkBin *playersinkbin)
+{
+#ifdef USE_GST1
+	GstPlayerSinkBinInput *active = &playersinkbin->inputs[playersinkbin->active_input];
+	GstPlayerSinkBinInput *standby = &playersinkbin->inputs[!playersinkbin->active_input];
+
+	if (!standby->bin || !standby->video_src)
+	{
+		GST_WARNING_OBJECT(playersinkbin,"playersinkbin : no prerolled standby input to swap to\n");
+		return FALSE;
+	}
+	if (!ensureVideoSink(playersinkbin))
+		return FALSE;
+	if (standby->audio_src && audioEnabled(playersinkbin))
+		ensureAudioSink(playersinkbin);
+
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : swapping input %u for standby input %u (gop cache %u bytes)\n",
+	                playersinkbin->active_input, !playersinkbin->active_input, standby->gop_cache_bytes);
+
+	GST_OBJECT_LOCK(playersinkbin);
+	playersinkbin->swap_start = gst_util_get_timestamp();
+	playersinkbin->active_input = !playersinkbin->active_input;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	swapOutput(playersinkbin, active, standby, videoSinkEntry(playersinkbin), TRUE);
+	swapOutput(playersinkbin, active, standby, audioSinkEntry(playersinkbin), FALSE);
+	linkAdOutput(playersinkbin, active, standby);
+	gst_element_sync_state_with_parent(playersinkbin->video_sink);
+	updateActiveInput(playersinkbin);
+
+	postEvent (playersinkbin, GSTPLAYERSINKBIN_EVENT_HAVE_VIDEO);
+	if (standby->audio_src && playersinkbin->m_aconvert)
+		postEvent (playersinkbin, GSTPLAYERSINKBIN_EVENT_HAVE_AUDIO);
+
+	return TRUE;
+#else
+	GST_WARNING_OBJECT(playersinkbin,"playersinkbin : standby input needs GStreamer 1.x\n");
+	return FALSE;
+#endif
+}
+
+#ifdef USE_GST1
+/* The standby_sink request pad always feeds input 1, the sink pad input 0 */
+static GstPad*
+gst_player_sinkbin_request_new_pad (GstElement * element, GstPadTemplate * templ,
+    const gchar * name, const GstCaps * caps)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN (element);
+	GstPad *target;
+	GstPad *gpad;
+
+	if (playersinkbin->standby_pad)
+	{
+		GST_WARNING_OBJECT(playersinkbin,"playersinkbin : standby_sink pad already requested\n");
+		return NULL;
+	}
+	if (!createInput(playersinkbin, 1))
+		return NULL;
+
+	target = gst_element_get_static_pad (playersinkbin->inputs[1].bin, "sink");
+	gpad = gst_ghost_pad_new_from_template ("standby_sink", target, templ);
+	gst_object_unref (target);
+	gst_pad_set_active (gpad, TRUE);
+	gst_element_add_pad (element, gpad);
+	gst_element_sync_state_with_parent (playersinkbin->inputs[1].bin);
+	playersinkbin->standby_pad = gpad;
+
+	return gpad;
+}
+
+static void
+gst_player_sinkbin_release_pad (GstElement * element, GstPad * pad)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN (element);
+
+	if (pad != playersinkbin->standby_pad)
+		return;
+
+	destroyInput(playersinkbin, &playersinkbin->inputs[1]);
+
+	/* Give the sinks back to the sink pad's input */
+	if (playersinkbin->active_input == 1)
+	{
+		OutputSwap swap = { NULL, &playersinkbin->inputs[0], TRUE };
+		GstPad *sink_pad;
+
+		playersinkbin->active_input = 0;
+		if (playersinkbin->video_sink)
 		{
-			FILE* fp= fopen(AV_STATUS,"a");
-			fwrite("Audio:SUCCESS",1,13,fp);
-			fclose(fp);
+			sink_pad = gst_element_get_static_pad(videoSinkEntry(playersinkbin), "sink");
+			relinkOutput(&swap, sink_pad);
+			gst_object_unref(sink_pad);
 		}
-		else
+		swap.is_video = FALSE;
+		if (playersinkbin->m_aconvert)
 		{
-			FILE* fp= fopen(AV_STATUS,"w");
-			fwrite("Audio:SUCCESS",1,13,fp);
-			avstatus=1;
-			fclose(fp);
+			sink_pad = getEntryPad(playersinkbin, audioSinkEntry(playersinkbin));
+			relinkOutput(&swap, sink_pad);
+			gst_object_unref(sink_pad);
 		}
-         }
-        }
+		linkAdOutput(playersinkbin, NULL, &playersinkbin->inputs[0]);
+		updateActiveInput(playersinkbin);
 	}
 
-	gst_caps_unref (caps);
+	playersinkbin->standby_pad = NULL;
+	gst_pad_set_active (pad, FALSE);
+	gst_element_remove_pad (element, pad);
+}
+#endif
+
+static GstStructure*
+gst_player_sinkbin_get_stats (GstPlayerSinkBin *playersinkbin)
+{
+	GstPlayerSinkBinInput *active;
+	GstPlayerSinkBinInput *standby;
+	GstStructure *stats;
+	guint vlevel = 0;
+	guint alevel = 0;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	active = &playersinkbin->inputs[playersinkbin->active_input];
+	standby = &playersinkbin->inputs[!playersinkbin->active_input];
+	stats = gst_structure_new ("playersinkbin-stats",
+	                           "active-input", G_TYPE_UINT, playersinkbin->active_input,
+	                           "in-buffers", G_TYPE_UINT64, active->in_buffers,
+	                           "in-bytes", G_TYPE_UINT64, active->in_bytes,
+	                           "in-pulls", G_TYPE_UINT64, active->in_pulls,
+	                           "demux-time", G_TYPE_UINT64, active->demux_time,
+	                           "ingest-chunks", G_TYPE_UINT64, active->ingest_chunks,
+	                           "decoded-frames", G_TYPE_UINT64, active->decoded_frames,
+	                           "decode-time-avg", G_TYPE_UINT64, active->decoded_frames ? active->decode_time / active->decoded_frames : 0,
+	                           "decode-time-max", G_TYPE_UINT64, active->decode_time_max,
+	                           "decoder-threads", G_TYPE_INT, active->decoder_threads,
+	                           "video-lowres", G_TYPE_INT, active->lowres,
+	                           "deinterlace-method", G_TYPE_STRING, active->video_deinterlace ? active->deinterlace_method : "none",
+	                           "low-power", G_TYPE_BOOLEAN, playersinkbin->low_power,
+	                           "audio-stretched", G_TYPE_BOOLEAN, playersinkbin->m_scaletempo && playersinkbin->play_speed != DEFAULT_PLAY_SPEED,
+	                           "audio-teardowns", G_TYPE_UINT, playersinkbin->audio_teardowns,
+	                           "video-degraded", G_TYPE_BOOLEAN, playersinkbin->video_degraded,
+	                           "resource-preemptions", G_TYPE_UINT, playersinkbin->resource_preemptions,
+	                           "ad-descriptors", G_TYPE_UINT64, active->ad_descriptors,
+	                           "ad-fade", G_TYPE_UINT, (guint) active->ad_fade,
+	                           "ad-pan", G_TYPE_UINT, (guint) active->ad_pan_byte,
+	                           "codec-changes", G_TYPE_UINT, active->codec_changes,
+	                           "last-codec-change-latency", G_TYPE_UINT64, active->last_codec_change_latency,
+	                           "last-swap-latency", G_TYPE_UINT64, playersinkbin->last_swap_latency,
+	                           "last-seek-latency", G_TYPE_UINT64, playersinkbin->last_seek_latency,
+	                           "keyframe-index-entries", G_TYPE_UINT, playersinkbin->keyframe_index->len,
+	                           "video-restarts", G_TYPE_UINT, playersinkbin->video_watch.restarts,
+	                           "audio-restarts", G_TYPE_UINT, playersinkbin->audio_watch.restarts,
+	                           "last-video-recovery", G_TYPE_UINT64, playersinkbin->video_watch.last_recovery,
+	                           "last-audio-recovery", G_TYPE_UINT64, playersinkbin->audio_watch.last_recovery,
+	                           "video-gop-duration", G_TYPE_UINT64, playersinkbin->video_watch.gop,
+	                           "events-posted", G_TYPE_UINT64, playersinkbin->events_posted,
+	                           "events-coalesced", G_TYPE_UINT64, playersinkbin->events_coalesced,
+	                           "event-delay-last", G_TYPE_UINT64, playersinkbin->event_delay_last,
+	                           "event-delay-max", G_TYPE_UINT64, playersinkbin->event_delay_max,
+	                           NULL);
+#ifdef USE_GST1
+	if (active->ts_health.pids)
+		tsHealthStats(&active->ts_health, stats);
+#endif
+	if (playersinkbin->scte35_count)
+	{
+		gst_structure_set (stats,
+		                   "scte35-cues", G_TYPE_UINT64, playersinkbin->scte35_count,
+		                   "scte35-lead-time", G_TYPE_INT64, playersinkbin->scte35_lead_time,
+		                   "scte35-lead-time-min", G_TYPE_INT64, playersinkbin->scte35_lead_time_min,
+		                   "scte35-latency", G_TYPE_UINT64, playersinkbin->scte35_latency,
+		                   "scte35-latency-max", G_TYPE_UINT64, playersinkbin->scte35_latency_max,
+		                   NULL);
+	}
+	if (playersinkbin->subtitle_ring)
+	{
+		gst_structure_set (stats,
+		                   "subtitle-records", G_TYPE_UINT64, playersinkbin->subtitle_records,
+		                   "subtitle-dropped", G_TYPE_UINT64, __atomic_load_n(&playersinkbin->subtitle_ring->dropped, __ATOMIC_RELAXED),
+		                   NULL);
+	}
+	if (playersinkbin->n_tiles)
+	{
+		guint i;
+
+		gst_structure_set (stats, "mosaic-tiles", G_TYPE_UINT, playersinkbin->n_tiles, NULL);
+		for (i = 0; i < playersinkbin->n_tiles; i++) {
+			GstPlayerSinkBinTile *tile = &playersinkbin->tiles[i];
+			gchar *program = g_strdup_printf("tile%u-program", i);
+			gchar *cpu_time = g_strdup_printf("tile%u-cpu-time", i);
+			gchar *buffers = g_strdup_printf("tile%u-buffers", i);
+
+			gst_structure_set (stats,
+			                   program, G_TYPE_INT, tile->program,
+			                   cpu_time, G_TYPE_UINT64, tile->cpu_time,
+			                   buffers, G_TYPE_UINT64, tile->buffers,
+			                   NULL);
+			g_free(program);
+			g_free(cpu_time);
+			g_free(buffers);
+		}
+	}
+	if (standby->bin)
+	{
+		gst_structure_set (stats,
+		                   "standby-in-buffers", G_TYPE_UINT64, standby->in_buffers,
+		                   "standby-in-bytes", G_TYPE_UINT64, standby->in_bytes,
+		                   "standby-demux-time", G_TYPE_UINT64, standby->demux_time,
+		                   "standby-gop-cache-bytes", G_TYPE_UINT, standby->gop_cache_bytes,
+		                   NULL);
+	}
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	if (active->timeshift)
+	{
+		guint level = 0;
+		guint64 size = 0;
+
+		g_object_get(active->timeshift, "current-level-bytes", &level, "ring-buffer-max-size", &size, NULL);
+		GST_OBJECT_LOCK(playersinkbin);
+		gst_structure_set (stats,
+		                   "timeshift-size", G_TYPE_UINT64, size,
+		                   "timeshift-level-bytes", G_TYPE_UINT, level,
+		                   "timeshift-bytes-written", G_TYPE_UINT64, active->timeshift_bytes,
+		                   "timeshift-write-rate", G_TYPE_UINT64, active->timeshift_time ?
+		                       gst_util_uint64_scale(active->timeshift_bytes, GST_SECOND, active->timeshift_time) : 0,
+		                   NULL);
+		GST_OBJECT_UNLOCK(playersinkbin);
+	}
+
+	if (playersinkbin->vrate)
+	{
+		guint64 dropped = 0;
+
+		g_object_get(playersinkbin->vrate, "drop", &dropped, NULL);
+		gst_structure_set (stats, "rate-dropped-frames", G_TYPE_UINT64, dropped, NULL);
+	}
+
+	/* Memory held by the standby path: queued ES data on top of the GOP cache */
+	if (standby->bin)
+	{
+		if (standby->m_vqueue)
+			g_object_get(standby->m_vqueue, "current-level-bytes", &vlevel, NULL);
+		if (standby->m_aqueue)
+			g_object_get(standby->m_aqueue, "current-level-bytes", &alevel, NULL);
+		gst_structure_set (stats, "standby-queued-bytes", G_TYPE_UINT, vlevel + alevel, NULL);
+	}
+
+	return stats;
 }
 
 #ifdef USE_GST1
@@ -829,66 +6476,372 @@ GstPadProbeReturn demuxSrcPadProbe (GstPad * demux_src_pad, GstPadProbeInfo *inf
 
 	return GST_PAD_PROBE_REMOVE;
 }
-#endif
 
-void onDemuxSrcPadAdded(GstElement* element, GstPad *demux_src_pad, gpointer data)
+#ifdef HAVE_GST_MPEGTS
+/* SCTE-35 cues.
+ * tsdemux turns the splice_info_section of the program into an event sent
+ * down all its pads, with the splice times already mapped to running time,
+ * as soon as the section is complete; that is seconds ahead of the splice
+ * point, while the media in front of it is still queued. The cue is posted
+ * on the bus from there rather than when the event reaches the sinks, with
+ * how far ahead of the splice point it went out and how long after the data
+ * carrying it came into the bin.
+ */
+static void
+scte35Post (GstPlayerSinkBinInput *input, GstMpegtsSection *section, const GstMpegtsSCTESIT *sit,
+    const GstMpegtsSCTESpliceEvent *splice)
 {
-	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN (data);
+	GstPlayerSinkBin *playersinkbin = input->owner;
+	gboolean specified = splice ? (splice->program_splice_flag && splice->program_splice_time_specified) : sit->splice_time_specified;
+	guint64 time = splice ? splice->program_splice_time : sit->splice_time;
+	GstClockTime latency = gst_util_get_timestamp() - input->in_arrival;
+	GstClockTime running_time = GST_CLOCK_TIME_NONE;
+	GstClockTime pts = GST_CLOCK_TIME_NONE;
+	GstClockTime now = GST_CLOCK_TIME_NONE;
+	GstClockTimeDiff lead_time = GST_CLOCK_STIME_NONE;
+	GstClock *clock;
+	GstStructure *s;
+
+	clock = gst_element_get_clock(GST_ELEMENT(playersinkbin));
+	if (clock)
+	{
+		now = gst_clock_get_time(clock) - gst_element_get_base_time(GST_ELEMENT(playersinkbin));
+		gst_object_unref(clock);
+	}
+	if (splice && splice->splice_immediate_flag)
+		running_time = now;
+	else if (specified && sit->is_running_time)
+		running_time = time;
+	else if (specified)
+		pts = (time + sit->pts_adjustment) & G_GUINT64_CONSTANT(0x1ffffffff);  /* 90 kHz */
+	if (GST_CLOCK_TIME_IS_VALID(running_time) && GST_CLOCK_TIME_IS_VALID(now))
+		lead_time = GST_CLOCK_DIFF(now, running_time);
+
+	s = gst_structure_new("playersinkbin-scte35",
+	        "command", G_TYPE_UINT, (guint) sit->splice_command_type,
+	        "event-id", G_TYPE_UINT, splice ? splice->splice_event_id : 0,
+	        "cancel", G_TYPE_BOOLEAN, splice && splice->splice_event_cancel_indicator,
+	        "out-of-network", G_TYPE_BOOLEAN, splice && splice->out_of_network_indicator,
+	        "immediate", G_TYPE_BOOLEAN, splice && splice->splice_immediate_flag,
+	        "running-time", G_TYPE_UINT64, running_time,
+	        "pts", G_TYPE_UINT64, pts,
+	        "duration", G_TYPE_UINT64, (splice && splice->duration_flag) ?
+	            gst_util_uint64_scale(splice->break_duration, GST_SECOND, 90000) : GST_CLOCK_TIME_NONE,
+	        "auto-return", G_TYPE_BOOLEAN, splice && splice->break_duration_auto_return,
+	        "unique-program-id", G_TYPE_UINT, splice ? (guint) splice->unique_program_id : 0,
+	        "lead-time", G_TYPE_INT64, lead_time,
+	        "latency", G_TYPE_UINT64, latency,
+	        "standby", G_TYPE_BOOLEAN, input != &playersinkbin->inputs[playersinkbin->active_input],
+	        "section", GST_TYPE_MPEGTS_SECTION, section,
+	        NULL);
+	gst_element_post_message(GST_ELEMENT(playersinkbin), gst_message_new_element(GST_OBJECT(playersinkbin), s));
+
+	GST_OBJECT_LOCK(playersinkbin);
+	if (lead_time != GST_CLOCK_STIME_NONE)
+	{
+		if (playersinkbin->scte35_lead_time_min == GST_CLOCK_STIME_NONE || lead_time < playersinkbin->scte35_lead_time_min)
+			playersinkbin->scte35_lead_time_min = lead_time;
+		playersinkbin->scte35_lead_time = lead_time;
+	}
+	playersinkbin->scte35_count++;
+	playersinkbin->scte35_latency = latency;
+	if (latency > playersinkbin->scte35_latency_max)
+		playersinkbin->scte35_latency_max = latency;
+	GST_OBJECT_UNLOCK(playersinkbin);
+
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : SCTE-35 command 0x%02x event %u at %" GST_TIME_FORMAT ", %" G_GINT64_FORMAT " ns ahead\n",
+	                sit->splice_command_type, splice ? splice->splice_event_id : 0, GST_TIME_ARGS(running_time), lead_time);
+}
 
-	gchar *padname = gst_pad_get_name(demux_src_pad);
+static GstPadProbeReturn
+scte35Probe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBinInput *input = (GstPlayerSinkBinInput *) data;
+	GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+	const GstMpegtsSCTESIT *sit;
+	GstMpegtsSection *section;
+	guint i;
 
-#ifdef ENABLE_SUBTEC
-	if (g_strrstr( padname, "subpicture"))
+	if (GST_EVENT_TYPE(event) != GST_EVENT_CUSTOM_DOWNSTREAM || gst_event_get_seqnum(event) == input->scte35_seqnum)
+		return GST_PAD_PROBE_OK;
+	section = gst_event_parse_mpegts_section(event);
+	if (!section)
+		return GST_PAD_PROBE_OK;
+	if (section->section_type == GST_MPEGTS_SECTION_SCTE_SIT && (sit = gst_mpegts_section_get_scte_sit(section)))
 	{
-		// create SUBTEC filter:
-		GstElement *subtecfilter = gst_element_factory_make("subtecfilter", "player_subtecfilter");
-		if (subtecfilter == NULL)
+		/* Same seqnum on every pad, the demuxer's thread pushes them all */
+		input->scte35_seqnum = gst_event_get_seqnum(event);
+		if (sit->splice_command_type == GST_MTS_SCTE_SPLICE_COMMAND_INSERT)
 		{
-			g_print("[%s :: %s] ERROR while creating SUBTECFILTER\n", __FILE__, __FUNCTION__);
-			goto done;
+			for (i = 0; sit->splices && i < sit->splices->len; i++)
+				scte35Post(input, section, sit, g_ptr_array_index(sit->splices, i));
 		}
+		else if (sit->splice_command_type != GST_MTS_SCTE_SPLICE_COMMAND_NULL)
+			scte35Post(input, section, sit, NULL);
+	}
+	gst_mpegts_section_unref(section);
 
-		// create SUBTEC sink:
-		GstElement *subtec_sink = gst_element_factory_make("subtecsink", "player_subtec_sink");
-		if (!subtec_sink) {
-			gst_object_unref(subtecfilter);
-			subtecfilter = NULL;
-			g_print("[%s] ERROR while creating sink element for subtecfilter\n", __FUNCTION__);
-			goto done;
+	return GST_PAD_PROBE_OK;
+}
+#endif
+#endif
+
+#ifdef ENABLE_SUBTEC
+/* Subtitle delivery.
+ * The subpicture chain is built by setupSubtec from the bin's async thread
+ * while the demuxer pad is held by a blocking probe, so pad-added returns at
+ * once and no PES unit is lost. With "subtitle-ring" the subtecfilter output
+ * goes to a fakesink whose pad probe publishes every PES unit into the shared
+ * memory ring instead of the subtecsink file.
+ */
+typedef struct _SubtecSetup
+{
+	GstElement *demux;
+	GstPad *pad;
+	gulong block;
+} SubtecSetup;
+
+static void
+freeSubtecSetup (gpointer data)
+{
+	SubtecSetup *setup = (SubtecSetup *) data;
+
+	gst_object_unref(setup->demux);
+	gst_object_unref(setup->pad);
+	g_free(setup);
+}
+
+/* Map the ring the first time, TRUE when it is in use */
+static gboolean
+openSubtitleRing (GstPlayerSinkBin *playersinkbin)
+{
+	GstPlayerSinkBinSubtitleRing *ring;
+	guint64 size = 4096;
+	gsize map_size;
+	gchar *name;
+	int fd;
+
+	GST_OBJECT_LOCK(playersinkbin);
+	name = g_strdup(playersinkbin->subtitle_ring_name);
+	while (size < playersinkbin->subtitle_ring_size)
+		size <<= 1;
+	GST_OBJECT_UNLOCK(playersinkbin);
+	if (!name || playersinkbin->subtitle_ring)
+	{
+		g_free(name);
+		return playersinkbin->subtitle_ring != NULL;
+	}
+
+	map_size = sizeof(GstPlayerSinkBinSubtitleRing) + size;
+	fd = shm_open(name, O_CREAT | O_RDWR, 0660);
+	if (fd < 0 || ftruncate(fd, map_size) < 0)
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to create subtitle ring %s\n", name);
+		if (fd >= 0)
+			close(fd);
+		g_free(name);
+		return FALSE;
+	}
+	ring = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (ring == MAP_FAILED)
+	{
+		GST_ERROR_OBJECT(playersinkbin,"playersinkbin : Failed to map subtitle ring %s\n", name);
+		g_free(name);
+		return FALSE;
+	}
+	/* A fresh ring: the consumer checks the magic before anything else */
+	memset(ring, 0, sizeof(*ring));
+	ring->version = PLAYERSINKBIN_SUBTITLE_RING_VERSION;
+	ring->size = size;
+	__atomic_store_n(&ring->magic, PLAYERSINKBIN_SUBTITLE_RING_MAGIC, __ATOMIC_RELEASE);
+
+	playersinkbin->subtitle_ring = ring;
+	playersinkbin->subtitle_ring_map_size = map_size;
+	GST_INFO_OBJECT(playersinkbin,"playersinkbin : subtitle ring %s of %" G_GUINT64_FORMAT " bytes\n", name, size);
+	g_free(name);
+
+	return TRUE;
+}
+
+/* Producer side, FALSE when the record does not fit */
+static gboolean
+subtitleRingWrite (GstPlayerSinkBinSubtitleRing *ring, const GstPlayerSinkBinSubtitleRecord *record,
+    const guint8 *payload)
+{
+	guint64 head = ring->head;
+	guint64 tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+	guint64 need = (sizeof(*record) + record->length + 7) & ~(guint64) 7;
+	guint64 offset = head & (ring->size - 1);
+	guint64 skip = (offset + need > ring->size) ? ring->size - offset : 0;
+
+	if (need + skip > ring->size - (head - tail))
+	{
+		__atomic_add_fetch(&ring->dropped, 1, __ATOMIC_RELAXED);
+		return FALSE;
+	}
+	if (skip)
+	{
+		if (skip >= sizeof(*record))
+		{
+			GstPlayerSinkBinSubtitleRecord wrap = { 0, PLAYERSINKBIN_SUBTITLE_RECORD_WRAP, G_MAXUINT64, G_MAXUINT64 };
+			memcpy(ring->data + offset, &wrap, sizeof(wrap));
 		}
-		gst_element_set_locked_state(subtec_sink, TRUE);
-		gst_element_set_locked_state(subtecfilter, TRUE);
+		head += skip;
+		offset = 0;
+	}
+	memcpy(ring->data + offset, record, sizeof(*record));
+	memcpy(ring->data + offset + sizeof(*record), payload, record->length);
+	__atomic_store_n(&ring->head, head + need, __ATOMIC_RELEASE);
+
+	return TRUE;
+}
+
+static GstPadProbeReturn
+subtitleRingProbe (GstPad *pad, GstPadProbeInfo *info, gpointer data)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN(data);
+	GstPlayerSinkBinSubtitleRecord record;
+	GstBuffer *buffer;
+	GstMapInfo map;
+
+	if (info->type & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM)
+	{
+		GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+
+		if (GST_EVENT_TYPE(event) == GST_EVENT_SEGMENT)
+			gst_event_copy_segment(event, &playersinkbin->subtitle_segment);
+		else if (GST_EVENT_TYPE(event) == GST_EVENT_FLUSH_STOP)
+			playersinkbin->subtitle_discont = TRUE;
+		return GST_PAD_PROBE_OK;
+	}
+
+	buffer = GST_PAD_PROBE_INFO_BUFFER(info);
+	if (!gst_buffer_map(buffer, &map, GST_MAP_READ))
+		return GST_PAD_PROBE_OK;
+	record.length = map.size;
+	record.flags = (playersinkbin->subtitle_discont || GST_BUFFER_IS_DISCONT(buffer)) ? PLAYERSINKBIN_SUBTITLE_RECORD_DISCONT : 0;
+	record.pts = GST_BUFFER_PTS_IS_VALID(buffer) ? GST_BUFFER_PTS(buffer) : G_MAXUINT64;
+	record.running_time = GST_BUFFER_PTS_IS_VALID(buffer) ?
+	    gst_segment_to_running_time(&playersinkbin->subtitle_segment, GST_FORMAT_TIME, GST_BUFFER_PTS(buffer)) : G_MAXUINT64;
+	/* A drop is reported on the next record that makes it */
+	playersinkbin->subtitle_discont = !subtitleRingWrite(playersinkbin->subtitle_ring, &record, map.data);
+	gst_buffer_unmap(buffer, &map);
+	if (!playersinkbin->subtitle_discont)
+	{
+		GST_OBJECT_LOCK(playersinkbin);
+		playersinkbin->subtitle_records++;
+		GST_OBJECT_UNLOCK(playersinkbin);
+	}
+
+	/* Delivered, the fakesink has nothing left to do */
+	return GST_PAD_PROBE_DROP;
+}
 
-		// add SUBTEC sink to pipeline:
-		gst_bin_add_many(GST_BIN(playersinkbin), subtecfilter, subtec_sink, NULL);
+static void
+setupSubtec (GstElement *element, gpointer data)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN (element);
+	SubtecSetup *setup = (SubtecSetup *) data;
+	GstElement *parent = GST_ELEMENT(GST_OBJECT_PARENT(setup->demux));
+	gboolean ring = openSubtitleRing(playersinkbin);
+	GstElement *subtecfilter;
+	GstElement *subtec_sink;
+	GstPad *pad;
+
+	// create SUBTEC filter:
+	subtecfilter = gst_element_factory_make("subtecfilter", "player_subtecfilter");
+	if (subtecfilter == NULL)
+	{
+		g_print("[%s :: %s] ERROR while creating SUBTECFILTER\n", __FILE__, __FUNCTION__);
+		goto done;
+	}
+
+	// create SUBTEC sink, or the sink the ring is fed from:
+	subtec_sink = gst_element_factory_make(ring ? "fakesink" : "subtecsink", "player_subtec_sink");
+	if (!subtec_sink) {
+		gst_object_unref(subtecfilter);
+		g_print("[%s] ERROR while creating sink element for subtecfilter\n", __FUNCTION__);
+		goto done;
+	}
+
+	// add SUBTEC sink to the input the demux belongs to:
+	gst_bin_add_many(GST_BIN(parent), subtecfilter, subtec_sink, NULL);
+	if (ring) {
+		g_object_set(subtec_sink, "sync", FALSE, "async", FALSE, NULL);
+		gst_segment_init(&playersinkbin->subtitle_segment, GST_FORMAT_TIME);
+		playersinkbin->subtitle_discont = TRUE;
+		pad = gst_element_get_static_pad(subtec_sink, "sink");
+		gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM | GST_PAD_PROBE_TYPE_EVENT_FLUSH,
+		    subtitleRingProbe, playersinkbin, NULL);
+		gst_object_unref(pad);
+	}
+	else
 		g_object_set(subtec_sink, "location", "/var/run/subttx/pes_data_main", NULL);
-		if (!gst_element_link(subtecfilter, subtec_sink)) {
-			g_print("[%s] Could not link SUBTECFILTER with SUBTECSINK\n", __FUNCTION__);
-			goto done;
-		}
-		if (!gst_element_link_pads(playersinkbin->demux, padname, subtecfilter, NULL)) {
-			g_print("[%s] Could not link DEMUX with SUBTECFILTER\n", __FUNCTION__);
-			goto done;
-		}
+	if (!gst_element_link(subtecfilter, subtec_sink)) {
+		g_print("[%s] Could not link SUBTECFILTER with SUBTECSINK\n", __FUNCTION__);
+		goto done;
+	}
+	pad = gst_element_get_static_pad(subtecfilter, "sink");
+	if (!GST_PAD_LINK_SUCCESSFUL(gst_pad_link(setup->pad, pad))) {
+		g_print("[%s] Could not link DEMUX with SUBTECFILTER\n", __FUNCTION__);
+		gst_object_unref(pad);
+		goto done;
+	}
+	gst_object_unref(pad);
 
-		if (playersinkbin->video_decoder) {
-			if (!gst_element_link_pads(playersinkbin->video_decoder, "user-data-pad", subtecfilter, "sink-user-data")) {
-				g_print("[%s] Could not link VDEC with SUBTECFILTER\n", __FUNCTION__);
-			}
+	if (playersinkbin->video_decoder) {
+		if (!gst_element_link_pads(playersinkbin->video_decoder, "user-data-pad", subtecfilter, "sink-user-data")) {
+			g_print("[%s] Could not link VDEC with SUBTECFILTER\n", __FUNCTION__);
 		}
+	}
+
+	gst_element_sync_state_with_parent(subtec_sink);
+	gst_element_sync_state_with_parent(subtecfilter);
+done:
+	/* Unlinked on failure: the demuxer carries on without subtitles */
+	if (setup->block)
+		gst_pad_remove_probe(setup->pad, setup->block);
+	setup->block = 0;
+}
+#endif
+
+void onDemuxSrcPadAdded(GstElement* element, GstPad *demux_src_pad, gpointer data)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN (data);
+
+	gchar *padname = gst_pad_get_name(demux_src_pad);
 
-		gst_element_set_state(subtecfilter, GST_STATE_PLAYING);
-		gst_element_set_state(subtec_sink, GST_STATE_PLAYING);
-		gst_element_set_locked_state(subtec_sink, FALSE);
-		gst_element_set_locked_state(subtecfilter, FALSE);
+#ifdef ENABLE_SUBTEC
+	if (g_strrstr( padname, "subpicture"))
+	{
+		SubtecSetup *setup = g_new0(SubtecSetup, 1);
 
-		gst_element_sync_state_with_parent(subtec_sink);
-		gst_element_sync_state_with_parent(subtecfilter);
+		setup->demux = gst_object_ref(element);
+		setup->pad = gst_object_ref(demux_src_pad);
+#ifdef USE_GST1
+		/* Held until setupSubtec has linked it, off this streaming thread */
+		setup->block = gst_pad_add_probe(demux_src_pad, GST_PAD_PROBE_TYPE_BLOCK_DOWNSTREAM, NULL, NULL, NULL);
+		gst_element_call_async(GST_ELEMENT(playersinkbin), setupSubtec, setup, freeSubtecSetup);
+#else
+		setupSubtec(GST_ELEMENT(playersinkbin), setup);
+		freeSubtecSetup(setup);
+#endif
 		goto done;
 	}
 #endif
 
 #ifdef USE_GST1
+#ifdef HAVE_GST_MPEGTS
+	if (playersinkbin->scte35_cues)
+	{
+		GstPlayerSinkBinInput *input = getInputForPad(playersinkbin, demux_src_pad);
+
+		if (input)
+			gst_pad_add_probe (demux_src_pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
+				scte35Probe, input, NULL);
+	}
+#endif
 	gst_pad_add_probe (demux_src_pad, GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM,
 		demuxSrcPadProbe, playersinkbin, NULL);
 #else
@@ -912,7 +6865,6 @@ gst_player_sinkbin_init (GstPlayerSinkBin* sinkbin)
 	GstPadTemplate *pad_tmpl;
 
 	/* Initialize properties */
-	audio_flag = 0;
 	sinkbin->prog_no = DEFAULT_PROGRAM_NUM;
 	strncpy(sinkbin->available_languages,DEFAULT_AVAILABLE_LANGUAGES,sizeof(DEFAULT_AVAILABLE_LANGUAGES));
 	strncpy(sinkbin->preffered_language,DEFAULT_PREFERRED_LANGUAGE,sizeof(DEFAULT_PREFERRED_LANGUAGE));
@@ -921,46 +6873,52 @@ gst_player_sinkbin_init (GstPlayerSinkBin* sinkbin)
 	sinkbin->plane = DEFAULT_PLANE;
 	sinkbin->video_mute = DEFAULT_VIDEO_MUTE;
 	sinkbin->play_speed = DEFAULT_PLAY_SPEED;
+	sinkbin->stretch_min_speed = DEFAULT_STRETCH_MIN_SPEED;
+	sinkbin->stretch_max_speed = DEFAULT_STRETCH_MAX_SPEED;
+	sinkbin->subtitle_ring_size = DEFAULT_SUBTITLE_RING_SIZE;
+	sinkbin->ts_health_interval = DEFAULT_TS_HEALTH_INTERVAL;
+	sinkbin->scte35_lead_time = sinkbin->scte35_lead_time_min = GST_CLOCK_STIME_NONE;
 	sinkbin->current_position = DEFAULT_CURRENT_POSITION;
 	sinkbin->resolution = DEFAULT_RESOLUTION;
 	sinkbin->audio_mute = DEFAULT_AUDIO_MUTE;
 	sinkbin->volume = DEFAULT_VOLUME;
+	sinkbin->active_input = 0;
+	sinkbin->swap_start = GST_CLOCK_TIME_NONE;
+	sinkbin->last_swap_latency = 0;
+	sinkbin->is_live = DEFAULT_LIVE;
+	sinkbin->seek_start = GST_CLOCK_TIME_NONE;
+	sinkbin->last_seek_latency = 0;
+	sinkbin->timeshift_duration = DEFAULT_TIMESHIFT_DURATION;
+	sinkbin->watchdog_timeout = DEFAULT_WATCHDOG_TIMEOUT;
+	sinkbin->async_events = DEFAULT_ASYNC_EVENTS;
+	sinkbin->low_power = DEFAULT_LOW_POWER;
+	sinkbin->low_power_framerate = DEFAULT_LOW_POWER_FRAMERATE;
+	sinkbin->resource_priority = DEFAULT_RESOURCE_PRIORITY;
+	g_queue_init(&sinkbin->event_queue);
+	sinkbin->video_watch.last_buffer = sinkbin->audio_watch.last_buffer = GST_CLOCK_TIME_NONE;
+	sinkbin->video_watch.restart_start = sinkbin->audio_watch.restart_start = GST_CLOCK_TIME_NONE;
+	sinkbin->video_watch.last_keyframe = sinkbin->video_watch.gop = GST_CLOCK_TIME_NONE;
+	sinkbin->timeshift_bitrate = DEFAULT_TIMESHIFT_BITRATE;
+	sinkbin->keyframe_index = g_array_new(FALSE, FALSE, sizeof(GstPlayerSinkBinIndexEntry));
+	gst_segment_init(&sinkbin->keyframe_index_segment, GST_FORMAT_TIME);
+	sinkbin->ingest_chunk_size = DEFAULT_INGEST_CHUNK_SIZE;
+	sinkbin->ingest_latency = DEFAULT_INGEST_LATENCY;
+	sinkbin->conf = mediaConfRef();
+	mediaConfDefaults(sinkbin);
+	g_cond_init(&sinkbin->tick_cond);
 
         printf("gst_player_sinkbin_init===\n");
-        {
- 	   FILE*fp=NULL;
-	   char data[50];
-               fp= fopen(MEDIA_CONF,"r");
-              if(fp)
- 	      {
-		fgets(data,30,fp);
-                if(strstr(data,"OMX"))
-                {
-		   OMX_Enable=1;
-		}
-                if(strstr(data,"Audio_Disable"))
-		{
-			Audio_Enable=0;
-		}
-	      }
-	}
 
-	sinkbin->demux = gst_element_factory_make(DEMUX, "player_demux");
-
-	if (!sinkbin->demux)
-	{
-		GST_ERROR_OBJECT(sinkbin,"playersinkbin : Failed to instantiate demuxer (%s)", DEMUX);
+	if (!createInput(sinkbin, 0))
 		return;
-	}
-	g_signal_connect(sinkbin->demux, "pad-added", G_CALLBACK (onDemuxSrcPadAdded), sinkbin);
+	updateActiveInput(sinkbin);
 
 
 	/* Install Resolution Change Signal callback */
 	GST_INFO_OBJECT(sinkbin,"playersinkbin::Installing signal callback for resolution change on video decoder\n");
 
-        gst_bin_add(GST_BIN(sinkbin), sinkbin->demux);
-	/* get the sinkpad of demux and ghost it */
-        pad = gst_element_get_static_pad (sinkbin->demux, "sink");
+	/* get the sinkpad of the demux front-end and ghost it */
+        pad = gst_element_get_static_pad (sinkbin->inputs[0].bin, "sink");
 
 	/* get the pad template */
 	pad_tmpl = gst_static_pad_template_get (&playersink_bin_sink_template);
@@ -978,11 +6936,91 @@ gst_player_sinkbin_init (GstPlayerSinkBin* sinkbin)
 static void gst_decode_bin_dispose (GObject * object)
 {
 	GstPlayerSinkBin* playersinkbin;
+	guint i;
 
 	playersinkbin=GST_PLAYER_SINKBIN(object);
 
 	if (playersinkbin->caps)
 		gst_caps_unref (playersinkbin->caps);
+	playersinkbin->caps = NULL;
+	gst_caps_replace(&playersinkbin->m_vcaps, NULL);
+
+#ifdef USE_GST1
+	g_list_free_full(playersinkbin->snapshot_pending, freeSnapshotRequest);
+	playersinkbin->snapshot_pending = NULL;
+#endif
+	for (i = 0; i < PLAYERSINKBIN_MAX_INPUTS; i++) {
+		clearGopCache(&playersinkbin->inputs[i]);
+		gst_caps_replace(&playersinkbin->inputs[i].video_caps, NULL);
+		gst_caps_replace(&playersinkbin->inputs[i].audio_caps, NULL);
+	}
+	for (i = 0; i < PLAYERSINKBIN_THREAD_MAX; i++) {
+		g_free(playersinkbin->thread_sched[i]);
+		playersinkbin->thread_sched[i] = NULL;
+	}
+	if (playersinkbin->keyframe_index)
+	{
+		keyframeIndexSave(playersinkbin);
+		g_array_free(playersinkbin->keyframe_index, TRUE);
+		playersinkbin->keyframe_index = NULL;
+	}
+	g_free(playersinkbin->keyframe_index_location);
+	playersinkbin->keyframe_index_location = NULL;
+	g_free(playersinkbin->timeshift_location);
+	playersinkbin->timeshift_location = NULL;
+	g_free(playersinkbin->mosaic_programs);
+	playersinkbin->mosaic_programs = NULL;
+	g_free(playersinkbin->deinterlace_method);
+	playersinkbin->deinterlace_method = NULL;
+	if (playersinkbin->subtitle_ring)
+	{
+		munmap(playersinkbin->subtitle_ring, playersinkbin->subtitle_ring_map_size);
+		playersinkbin->subtitle_ring = NULL;
+		if (playersinkbin->subtitle_ring_name)
+			shm_unlink(playersinkbin->subtitle_ring_name);
+	}
+	g_free(playersinkbin->subtitle_ring_name);
+	playersinkbin->subtitle_ring_name = NULL;
+	if (playersinkbin->ad_main_pad)
+		gst_object_unref(playersinkbin->ad_main_pad);
+	playersinkbin->ad_main_pad = NULL;
+	/* Program pads go back to the TS parser, which frees its program filters */
+	for (i = 0; i < playersinkbin->n_tiles; i++) {
+		GstPad *parse_pad = playersinkbin->tiles[i].parse_pad;
+
+		if (!parse_pad)
+			continue;
+		if (playersinkbin->inputs[0].demux)
+			gst_element_release_request_pad(playersinkbin->inputs[0].demux, parse_pad);
+		gst_object_unref(parse_pad);
+		playersinkbin->tiles[i].parse_pad = NULL;
+	}
+	playersinkbin->n_tiles = 0;
+#ifdef USE_GST1
+	watchdogStop(playersinkbin);
+	tickStop(playersinkbin, &playersinkbin->ad_stall_id, &playersinkbin->ad_stall_thread);
+	tickStop(playersinkbin, &playersinkbin->ts_health_id, &playersinkbin->ts_health_thread);
+	tickStop(playersinkbin, &playersinkbin->ingest_tick_id, &playersinkbin->ingest_tick_thread);
+#endif
+	/* A queued dispatch holds a reference, so nothing is pending here */
+	if (playersinkbin->event_loop)
+	{
+		g_main_loop_quit(playersinkbin->event_loop);
+		if (playersinkbin->event_thread != g_thread_self())
+			g_thread_join(playersinkbin->event_thread);
+		else
+			g_thread_unref(playersinkbin->event_thread);
+		g_main_loop_unref(playersinkbin->event_loop);
+		playersinkbin->event_loop = NULL;
+		playersinkbin->event_thread = NULL;
+	}
+	if (playersinkbin->event_context)
+		g_main_context_unref(playersinkbin->event_context);
+	playersinkbin->event_context = NULL;
+
+	releaseVideoSlot(playersinkbin);
+	mediaConfUnref(playersinkbin->conf);
+	playersinkbin->conf = NULL;
 
 	G_OBJECT_CLASS (parent_class)->dispose (object);
 	system("cat /dev/null > /opt/gstcaps.txt");
@@ -995,6 +7033,15 @@ static void gst_decode_bin_dispose (GObject * object)
 		avstatus=0;
 }
 
+static void gst_decode_bin_finalize (GObject * object)
+{
+	GstPlayerSinkBin *playersinkbin = GST_PLAYER_SINKBIN (object);
+
+	g_cond_clear(&playersinkbin->tick_cond);
+
+	G_OBJECT_CLASS (parent_class)->finalize (object);
+}
+
 static void gst_player_sinkbin_get_pmtinfo(GstPlayerSinkBin* playersinkbin,GValue * value)
 {
 #ifndef USE_HW_DEMUX
@@ -1105,6 +7152,13 @@ gst_player_sinkbin_get_property (GObject * object, guint prop_id,
 		/* Get current decode handle from soc video decoder element
 		*/
 	{
+		/* The software fallback decoder has no handle to hand out */
+		if (!playersinkbin->video_decoder ||
+		        !g_object_class_find_property(G_OBJECT_GET_CLASS(playersinkbin->video_decoder), "decode-handle"))
+		{
+			g_value_set_pointer(value, NULL);
+			break;
+		}
 		g_object_get(playersinkbin->video_decoder,"decode-handle",&video_decoder_handle,NULL);
 		GST_DEBUG_OBJECT(playersinkbin,"gst_player_sinkbin_get_property::video_decoder_handle %d\n",video_decoder_handle);
 		playersinkbin->video_decode_handle = (gpointer) &video_decoder_handle;
@@ -1124,7 +7178,15 @@ gst_player_sinkbin_get_property (GObject * object, guint prop_id,
 	case PROP_VIDEO_RECTANGLE:
 		/* Get current value of the rectange from soc gstreamer element
 		 */
-		g_object_get(playersinkbin->video_sink,"rectangle",&(playersinkbin->video_rectangle),NULL);
+		if (playersinkbin->video_sink && videoSinkScales(playersinkbin))
+		{
+			gchar *rectangle = NULL;
+
+			g_object_get(playersinkbin->video_sink,"rectangle",&rectangle,NULL);
+			if (rectangle)
+				g_strlcpy(playersinkbin->video_rectangle, rectangle, sizeof(playersinkbin->video_rectangle));
+			g_free(rectangle);
+		}
 		g_value_set_string(value,playersinkbin->video_rectangle);
 		break;
 	case PROP_CC_DESC:
@@ -1179,61 +7241,127 @@ gst_player_sinkbin_get_property (GObject * object, guint prop_id,
 		g_object_get(playersinkbin->audio_sink,"volume",&(playersinkbin->volume),NULL);
 		g_value_set_double( value,playersinkbin->volume);
 		break;
+	case PROP_ACTIVE_INPUT:
+		g_value_set_uint(value, playersinkbin->active_input);
+		break;
+	case PROP_STATS:
+		g_value_take_boxed(value, gst_player_sinkbin_get_stats(playersinkbin));
+		break;
+	case PROP_INGEST_CHUNK_SIZE:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_uint(value, playersinkbin->ingest_chunk_size);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_INGEST_LATENCY:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_uint64(value, playersinkbin->ingest_latency);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_VIDEO_DECODER_THREADS:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_int(value, playersinkbin->video_decoder_threads);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_KEYFRAME_INDEX_LOCATION:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_string(value, playersinkbin->keyframe_index_location);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_TIMESHIFT_DURATION:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_uint64(value, playersinkbin->timeshift_duration);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_TIMESHIFT_BITRATE:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_uint(value, playersinkbin->timeshift_bitrate);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_TIMESHIFT_LOCATION:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_string(value, playersinkbin->timeshift_location);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_MOSAIC_PROGRAMS:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_string(value, playersinkbin->mosaic_programs);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_AD_PID:
+		g_value_set_uint(value, playersinkbin->ad_pid);
+		break;
+	case PROP_STRETCH_MIN_SPEED:
+		g_value_set_float(value, playersinkbin->stretch_min_speed);
+		break;
+	case PROP_STRETCH_MAX_SPEED:
+		g_value_set_float(value, playersinkbin->stretch_max_speed);
+		break;
+	case PROP_DEINTERLACE_METHOD:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_string(value, playersinkbin->deinterlace_method);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_SUBTITLE_RING:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_string(value, playersinkbin->subtitle_ring_name);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_SUBTITLE_RING_SIZE:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_uint(value, playersinkbin->subtitle_ring_size);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_SCTE35_CUES:
+		g_value_set_boolean(value, playersinkbin->scte35_cues);
+		break;
+	case PROP_TS_HEALTH_INTERVAL:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_uint(value, playersinkbin->ts_health_interval);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_WATCHDOG_TIMEOUT:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_uint64(value, playersinkbin->watchdog_timeout);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_ASYNC_EVENTS:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_boolean(value, playersinkbin->async_events);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_EVENT_CONTEXT:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_pointer(value, playersinkbin->event_context);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_LOW_POWER:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_boolean(value, playersinkbin->low_power);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_LOW_POWER_FRAMERATE:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_uint(value, playersinkbin->low_power_framerate);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_RESOURCE_PRIORITY:
+		g_mutex_lock(&resource_lock);
+		g_value_set_int(value, playersinkbin->resource_priority);
+		g_mutex_unlock(&resource_lock);
+		break;
+	case PROP_DEMUX_THREAD_SCHED:
+	case PROP_VIDEO_THREAD_SCHED:
+	case PROP_AUDIO_THREAD_SCHED:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_value_set_string(value, playersinkbin->thread_sched[prop_id - PROP_DEMUX_THREAD_SCHED]);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
 	}
 	/* END SOC CHANGES */
 }
-static  char * getResolution( const char *filename, unsigned int *pFileSize )
-{
-        int rc;
-        int lengthDidRead;
-        char *pData = NULL;
-
-        FILE* pFile= fopen( filename, "r" );
-        if ( pFile )
-        {
-                rc = fseek( pFile, 0, SEEK_END );
-                if ( rc )
-                {
-                        goto exit;
-                }
-
-                *pFileSize = ftell( pFile );
-                if ( -1 == *pFileSize )
-                {
-                        goto exit;
-                }
-
-                rc = fseek( pFile, 0, SEEK_SET );
-                if ( rc )
-                {
-                        goto exit;
-                }
-                pData = (char*)malloc( (*pFileSize +1) * sizeof(char) );
-                if ( !pData )
-                {
-                        goto exit;
-                }
-                lengthDidRead = fread( pData, sizeof(char), *pFileSize, pFile );
-
-   		 if ( lengthDidRead != *pFileSize )
-                {
-                        free( pData );
-                        goto exit;
-                }
-                pData[*pFileSize]= '\0';
-        }
-        else
-        {
-                return NULL;
-        }
-exit:
-  fclose( pFile );
-
-    return pData;
-}
 static void
 gst_player_sinkbin_set_property (GObject * object, guint prop_id,
                                  const GValue * value, GParamSpec * pspec)
@@ -1247,7 +7375,8 @@ gst_player_sinkbin_set_property (GObject * object, guint prop_id,
 		/*
 		* Set the program number on soc demux gstreamer element
 		 */
-		g_object_set(playersinkbin->demux, "program-number", playersinkbin->prog_no, NULL);
+		if (playersinkbin->demux && g_object_class_find_property(G_OBJECT_GET_CLASS(playersinkbin->demux), "program-number"))
+			g_object_set(playersinkbin->demux, "program-number", playersinkbin->prog_no, NULL);
 		break;
 	case PROP_PREFERRED_LANGUAGE:
 	{
@@ -1273,7 +7402,7 @@ gst_player_sinkbin_set_property (GObject * object, guint prop_id,
 				}
 			}
 			GST_DEBUG_OBJECT(playersinkbin,"gst_player_sinkbin_set_property::unlink pad %s preferred pid to set %s playersinkbin->num_audio_streams %d\n",playersinkbin->linkedaudiopadname,playersinkbin->prefferd_pid_instring,playersinkbin->num_audio_streams);
-			if(playersinkbin->num_audio_streams > 1) /* Change pads only if more than one audio */
+			if(playersinkbin->num_audio_streams > 1 && playersinkbin->demux) /* Change pads only if more than one audio */
 			{
 				GstPad *linkedpad = gst_element_get_static_pad(playersinkbin->demux,playersinkbin->linkedaudiopadname);
 				GST_DEBUG_OBJECT(playersinkbin,"gst_player_sinkbin_set_property::linked pad is %x\n", (unsigned int)linkedpad);
@@ -1319,7 +7448,18 @@ gst_player_sinkbin_set_property (GObject * object, guint prop_id,
 		memset(playersinkbin->video_rectangle, '\0', sizeof(playersinkbin->video_rectangle));
 		strncpy(playersinkbin->video_rectangle, g_value_get_string (value),sizeof(playersinkbin->video_rectangle));
 		playersinkbin->video_rectangle[sizeof(playersinkbin->video_rectangle)-1] = 0;
-                g_object_set(playersinkbin->video_sink,"rectangle", playersinkbin->video_rectangle, NULL);
+		{
+			guint width, height;
+
+			parseRectangle(playersinkbin->video_rectangle, &width, &height);
+			GST_OBJECT_LOCK(playersinkbin);
+			playersinkbin->rect_width = width;
+			playersinkbin->rect_height = height;
+			GST_OBJECT_UNLOCK(playersinkbin);
+		}
+		if (playersinkbin->video_sink && videoSinkScales(playersinkbin))
+			g_object_set(playersinkbin->video_sink,"rectangle", playersinkbin->video_rectangle, NULL);
+		updateVideoScaling(playersinkbin);
 		printf("setting rectangle = %s \n",playersinkbin->video_rectangle);
 		break;
 	case PROP_PLANE:
@@ -1333,24 +7473,28 @@ gst_player_sinkbin_set_property (GObject * object, guint prop_id,
 	}
 	break;
 	case PROP_IS_LIVE:
-		/*Currently is-live property is installed to remove warning messages
-		*/
-		printf("Setting is-live prop is not supported\n");
+		/* Takes effect when the input pads are next activated */
+		GST_OBJECT_LOCK(playersinkbin);
+		playersinkbin->is_live = g_value_get_boolean(value);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		GST_DEBUG_OBJECT(playersinkbin,"gst_player_sinkbin_set_property::is-live %d\n", playersinkbin->is_live);
 	break;
 	case PROP_PLAY_SPEED:
 		playersinkbin->play_speed = g_value_get_float(value);
 		GST_DEBUG_OBJECT(playersinkbin,"gst_player_sinkbin_set_property::setting play_speed %f\n",playersinkbin->play_speed);
 
 #if defined(ENABLE_AUDIO_REMOVAL_FOR_TRICK_MODES)
-		if ((playersinkbin->play_speed == DEFAULT_PLAY_SPEED) && (playersinkbin->audio_sink == NULL)) {
+		if (speedKeepsAudio(playersinkbin, playersinkbin->play_speed) && (playersinkbin->audio_sink == NULL)) {
 			// Link pads after bringing the state of the downstream elements to the state of the bin
 			createLinkAudioChain(playersinkbin);
 
 		}
-		else if ((playersinkbin->play_speed != DEFAULT_PLAY_SPEED) && (playersinkbin->audio_sink != NULL)) {
+		else if (!speedKeepsAudio(playersinkbin, playersinkbin->play_speed) && (playersinkbin->audio_sink != NULL)) {
 			deleteUnlinkAudioChain(playersinkbin);
 		}
 #endif
+		if (playersinkbin->play_speed != DEFAULT_PLAY_SPEED && speedKeepsAudio(playersinkbin, playersinkbin->play_speed))
+			ensureTimeStretch(playersinkbin);
 
 		break;
 	case PROP_RESOLUTION:
@@ -1362,7 +7506,7 @@ gst_player_sinkbin_set_property (GObject * object, guint prop_id,
 		break;
 	case PROP_AUDIO_MUTE:
 #if defined(ENABLE_AUDIO_REMOVAL_FOR_TRICK_MODES)
-		if ((playersinkbin->play_speed == DEFAULT_PLAY_SPEED) && (playersinkbin->audio_sink != NULL)) {
+		if (speedKeepsAudio(playersinkbin, playersinkbin->play_speed) && (playersinkbin->audio_sink != NULL)) {
 			playersinkbin->audio_mute = g_value_get_boolean(value);
 			g_object_set(playersinkbin->audio_sink, "mute",playersinkbin->audio_mute, NULL);
 		}
@@ -1381,6 +7525,159 @@ gst_player_sinkbin_set_property (GObject * object, guint prop_id,
 		 */
 		g_object_set(playersinkbin->audio_sink, "volume",playersinkbin->volume, NULL);
 		break;
+	case PROP_INGEST_CHUNK_SIZE:
+		/* Picked up by the streaming thread on the next input buffer */
+		GST_OBJECT_LOCK(playersinkbin);
+		playersinkbin->ingest_chunk_size = g_value_get_uint(value) - (g_value_get_uint(value) % TS_PACKET_SIZE);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_INGEST_LATENCY:
+		GST_OBJECT_LOCK(playersinkbin);
+		playersinkbin->ingest_latency = g_value_get_uint64(value);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_VIDEO_DECODER_THREADS:
+		/* Used for decoders created from now on */
+		GST_OBJECT_LOCK(playersinkbin);
+		playersinkbin->video_decoder_threads = g_value_get_int(value);
+		playersinkbin->video_decoder_threads_set = TRUE;
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_KEYFRAME_INDEX_LOCATION:
+		/* Flush the index of the previous recording and pick up the new one */
+		keyframeIndexSave(playersinkbin);
+		GST_OBJECT_LOCK(playersinkbin);
+		g_free(playersinkbin->keyframe_index_location);
+		playersinkbin->keyframe_index_location = g_value_dup_string(value);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		keyframeIndexLoad(playersinkbin);
+		break;
+	case PROP_TIMESHIFT_DURATION:
+		GST_OBJECT_LOCK(playersinkbin);
+		playersinkbin->timeshift_duration = g_value_get_uint64(value);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_TIMESHIFT_BITRATE:
+		GST_OBJECT_LOCK(playersinkbin);
+		playersinkbin->timeshift_bitrate = g_value_get_uint(value);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_TIMESHIFT_LOCATION:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_free(playersinkbin->timeshift_location);
+		playersinkbin->timeshift_location = g_value_dup_string(value);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_MOSAIC_PROGRAMS:
+		GST_OBJECT_LOCK(playersinkbin);
+		g_free(playersinkbin->mosaic_programs);
+		playersinkbin->mosaic_programs = g_value_dup_string(value);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_AD_PID:
+		playersinkbin->ad_pid = g_value_get_uint(value);
+		break;
+	case PROP_STRETCH_MIN_SPEED:
+		/* Applies from the next "play-speed" */
+		playersinkbin->stretch_min_speed = g_value_get_float(value);
+		break;
+	case PROP_STRETCH_MAX_SPEED:
+		playersinkbin->stretch_max_speed = g_value_get_float(value);
+		break;
+	case PROP_DEINTERLACE_METHOD:
+		/* Applies from the next interlaced stream */
+		GST_OBJECT_LOCK(playersinkbin);
+		g_free(playersinkbin->deinterlace_method);
+		playersinkbin->deinterlace_method = g_value_dup_string(value);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_SUBTITLE_RING:
+		/* Used from the next subtitle pad; a mapped ring keeps its name */
+		GST_OBJECT_LOCK(playersinkbin);
+		if (!playersinkbin->subtitle_ring)
+		{
+			g_free(playersinkbin->subtitle_ring_name);
+			playersinkbin->subtitle_ring_name = g_value_dup_string(value);
+		}
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_SUBTITLE_RING_SIZE:
+		GST_OBJECT_LOCK(playersinkbin);
+		playersinkbin->subtitle_ring_size = g_value_get_uint(value);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_SCTE35_CUES:
+		playersinkbin->scte35_cues = g_value_get_boolean(value);
+		break;
+	case PROP_TS_HEALTH_INTERVAL:
+		GST_OBJECT_LOCK(playersinkbin);
+		playersinkbin->ts_health_interval = g_value_get_uint(value);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_WATCHDOG_TIMEOUT:
+		GST_OBJECT_LOCK(playersinkbin);
+		playersinkbin->watchdog_timeout = g_value_get_uint64(value);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_ASYNC_EVENTS:
+		GST_OBJECT_LOCK(playersinkbin);
+		playersinkbin->async_events = g_value_get_boolean(value);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_EVENT_CONTEXT:
+	{
+		/* Already queued events still go to the previous context */
+		GMainContext *context = (GMainContext *) g_value_get_pointer(value);
+
+		if (context)
+			g_main_context_ref(context);
+		GST_OBJECT_LOCK(playersinkbin);
+		if (playersinkbin->event_context)
+			g_main_context_unref(playersinkbin->event_context);
+		playersinkbin->event_context = context;
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	}
+	case PROP_LOW_POWER:
+		GST_OBJECT_LOCK(playersinkbin);
+		playersinkbin->low_power = g_value_get_boolean(value);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		break;
+	case PROP_LOW_POWER_FRAMERATE:
+		GST_OBJECT_LOCK(playersinkbin);
+		playersinkbin->low_power_framerate = g_value_get_uint(value);
+		GST_OBJECT_UNLOCK(playersinkbin);
+		if (playersinkbin->vrate)
+			g_object_set(playersinkbin->vrate, "max-rate", (gint) g_value_get_uint(value), NULL);
+		break;
+	case PROP_RESOURCE_PRIORITY:
+		/* Counts from the next slot request */
+		g_mutex_lock(&resource_lock);
+		playersinkbin->resource_priority = g_value_get_int(value);
+		g_mutex_unlock(&resource_lock);
+		break;
+	case PROP_DEMUX_THREAD_SCHED:
+	case PROP_VIDEO_THREAD_SCHED:
+	case PROP_AUDIO_THREAD_SCHED:
+	{
+		/* Takes effect when the thread (re)starts */
+		guint thread = prop_id - PROP_DEMUX_THREAD_SCHED;
+		GstPlayerSinkBinThreadConfig config;
+
+		if (!parseThreadSched(g_value_get_string(value), &config))
+		{
+			GST_WARNING_OBJECT(playersinkbin,"playersinkbin : invalid %s thread scheduling \"%s\"\n",
+			                   threadName(thread), g_value_get_string(value));
+			break;
+		}
+		GST_OBJECT_LOCK(playersinkbin);
+		g_free(playersinkbin->thread_sched[thread]);
+		playersinkbin->thread_sched[thread] = g_value_dup_string(value);
+		playersinkbin->thread_config[thread] = config;
+		playersinkbin->thread_sched_set[thread] = TRUE;
+		GST_OBJECT_UNLOCK(playersinkbin);
+	}
+	break;
 	default:
 		G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
 		break;
@@ -1425,6 +7722,7 @@ playersinkbin_init (GstPlugin * plugin)
 	 */
 	GST_DEBUG_CATEGORY_INIT (gst_player_sinkbin_debug, "playersinkbin",
 	                         0, "playersinkbin");
+	mediaConfInit();
 
 	return gst_element_register (plugin, "playersinkbin", GST_RANK_NONE,
 	                             GST_TYPE_PLAYER_SINKBIN);
@@ -52,6 +52,315 @@ typedef struct _esinfo {
 	char lang[12];
 } esinfo_t;
 
+/* Streaming threads whose scheduling can be configured */
+typedef enum {
+	PLAYERSINKBIN_THREAD_DEMUX,
+	PLAYERSINKBIN_THREAD_VIDEO,
+	PLAYERSINKBIN_THREAD_AUDIO,
+	PLAYERSINKBIN_THREAD_MAX
+} GstPlayerSinkBinThread;
+
+typedef struct _GstPlayerSinkBinThreadConfig
+{
+	gint policy;    /* SCHED_* policy, -1 leaves scheduling untouched */
+	gint priority;
+	guint64 cpus;   /* CPU affinity mask, 0 leaves affinity untouched */
+} GstPlayerSinkBinThreadConfig;
+
+/* Frames in flight tracked for the software decoder's per-frame timing */
+#define PLAYERSINKBIN_DECODE_TIMING_SLOTS 32
+
+/* Keyframe index entry, also the record layout of the sidecar file */
+typedef struct _GstPlayerSinkBinIndexEntry
+{
+	guint64 time;   /* stream time of the keyframe */
+	guint64 offset; /* byte offset at or before its first TS packet */
+} GstPlayerSinkBinIndexEntry;
+
+/* Video buffers between demuxer and parser tracked for the keyframe index */
+#define PLAYERSINKBIN_INDEX_PENDING_SLOTS 32
+
+/* Process-wide media.conf snapshot, opaque */
+typedef struct _GstPlayerSinkBinMediaConf GstPlayerSinkBinMediaConf;
+
+/* Stall watchdog state of one output (video or audio) of the active input */
+typedef struct _GstPlayerSinkBinWatch
+{
+	GstClockTime last_buffer; /* when the sink last got a buffer */
+	guint64 in_buffers;       /* input buffers at that time */
+	gboolean restarting;
+	guint attempts;           /* restarts without a buffer reaching the sink */
+	GstPad* drop_pad;         /* demuxer pad whose data is dropped meanwhile */
+	gulong drop_probe;
+	GstClockTime restart_start;
+	guint restarts;
+	GstClockTime last_recovery;
+	GstClockTime last_keyframe; /* PTS of the last keyframe at the sink, video only */
+	GstClockTime gop;           /* distance of the last two keyframes */
+} GstPlayerSinkBinWatch;
+
+/* Audio description control of one AD PES, ETSI TS 101 154 annex E */
+typedef struct _GstPlayerSinkBinAdControl
+{
+	gboolean demuxed;  /* pts is set once its buffer left the demuxer */
+	GstClockTime pts;
+	gboolean valid;    /* the PES carried an AD descriptor */
+	guint8 fade;       /* main audio attenuation in 0.3 dB steps, 0xff mutes */
+	guint8 pan;        /* AD direction in 1/256 turns clockwise from centre */
+} GstPlayerSinkBinAdControl;
+
+/* AD PES seen on input and not yet played */
+#define PLAYERSINKBIN_AD_CONTROL_SLOTS 32
+
+/* Subtitle ring, see the "subtitle-ring" property. A POSIX shared memory
+ * object holding a ring header and the ring itself, written by this bin and
+ * read by one subtitle renderer. Positions only grow; the byte of a position
+ * is data[pos & (size - 1)]. The producer fills records in [head, tail + size)
+ * and then publishes them with a release store of head; the consumer reads
+ * [tail, head) after an acquire load of head and frees them with a release
+ * store of tail. Records start 8-byte aligned and never wrap: when less than
+ * a record header is left before the end, or a record has the WRAP flag, the
+ * consumer goes on at the start of the ring. */
+#define PLAYERSINKBIN_SUBTITLE_RING_MAGIC 0x53554252 /* "SUBR" */
+#define PLAYERSINKBIN_SUBTITLE_RING_VERSION 1
+
+#define PLAYERSINKBIN_SUBTITLE_RECORD_WRAP    (1 << 0) /* no payload, skip to the start */
+#define PLAYERSINKBIN_SUBTITLE_RECORD_DISCONT (1 << 1) /* first record after a flush or a drop */
+
+typedef struct _GstPlayerSinkBinSubtitleRecord
+{
+	guint32 length;        /* payload bytes following the record: one PES unit */
+	guint32 flags;
+	guint64 pts;           /* in ns, G_MAXUINT64 when unknown */
+	guint64 running_time;  /* of the pts, to match against the video clock */
+} GstPlayerSinkBinSubtitleRecord;
+
+typedef struct _GstPlayerSinkBinSubtitleRing
+{
+	guint32 magic;
+	guint32 version;
+	guint64 size;     /* of data, a power of two */
+	guint64 head;     /* written by the producer only */
+	guint64 tail;     /* written by the consumer only */
+	guint64 dropped;  /* records that did not fit */
+	guint8 data[];
+} GstPlayerSinkBinSubtitleRing;
+
+/* Transport stream health of an input, see the "ts-health-interval" property.
+ * The counters are the ETR 290 priority 1 and 2 indicators that can be told
+ * without parsing tables. */
+typedef struct _GstPlayerSinkBinTsCounters
+{
+	guint64 packets;
+	guint64 sync_losses;           /* 1.1, 2 bad sync bytes in a row */
+	guint64 sync_byte_errors;      /* 1.2 */
+	guint64 pat_errors;            /* 1.3a, no PAT for 0.5 s */
+	guint64 cc_errors;             /* 1.4 */
+	guint64 transport_errors;      /* 2.1, TEI set */
+	guint64 pcr_repetition_errors; /* 2.3a, PCRs more than 40 ms apart */
+	guint64 pcr_discontinuities;   /* 2.3b, PCR jump without discontinuity indicator */
+} GstPlayerSinkBinTsCounters;
+
+#define PLAYERSINKBIN_TS_PIDS 8192
+/* PCR PIDs followed and PIDs whose rate is reported */
+#define PLAYERSINKBIN_TS_PCR_PIDS 4
+#define PLAYERSINKBIN_TS_RATE_PIDS 32
+
+typedef struct _GstPlayerSinkBinTsPid
+{
+	guint64 bytes;  /* this interval */
+	guint32 cc_errors;
+	guint8 cc;
+	guint8 epoch;   /* cc is valid when this is the meter's epoch */
+} GstPlayerSinkBinTsPid;
+
+typedef struct _GstPlayerSinkBinTsRate
+{
+	guint pid;
+	guint64 bitrate;
+	guint32 cc_errors;
+} GstPlayerSinkBinTsRate;
+
+typedef struct _GstPlayerSinkBinTsHealth
+{
+	GstPlayerSinkBinTsPid* pids; /* PLAYERSINKBIN_TS_PIDS of them once the input is TS */
+	guint stride;  /* packet size, 192 for M2TS and 204 with Reed-Solomon */
+	guint prefix;  /* bytes in front of the sync byte */
+	guint8 epoch;
+	gboolean in_sync;
+	guint bad_run;
+	guint good_run;
+	guint8 residual[208]; /* packet straddling two buffers */
+	guint residual_fill;
+	guint64 next_offset;  /* pull mode, a read elsewhere is a discontinuity */
+	gboolean pat_pending; /* PAT in the buffer being metered */
+	struct {
+		guint pid;
+		guint64 pcr;  /* 27 MHz */
+		GstClockTime arrival;
+	} pcr[PLAYERSINKBIN_TS_PCR_PIDS];
+	guint n_pcr;
+	GstClockTime jitter;  /* published as pcr_jitter after each buffer */
+	GstClockTime jitter_max;
+
+	/* Under the object lock, also read by the bin's health tick */
+	GstClockTime pat_seen;
+	gboolean pat_missing;
+	GstClockTime interval_start;
+	GstClockTime last_arrival;
+	gboolean stalled;     /* the tick closed an interval without data */
+	GstPlayerSinkBinTsCounters total;
+	GstClockTime pcr_jitter;  /* smoothed, PCR clock against arrival clock */
+	GstClockTime pcr_jitter_max;
+	guint64 bitrate;          /* over the last interval */
+	GstPlayerSinkBinTsRate rates[PLAYERSINKBIN_TS_RATE_PIDS];
+	guint n_rates;
+} GstPlayerSinkBinTsHealth;
+
+/* Number of demux front-ends the bin can hold: the active one feeding the
+ * sinks and a prerolled standby one used for instant channel change. */
+#define PLAYERSINKBIN_MAX_INPUTS 2
+
+/* Demux front-end. Every input lives in its own sub-bin holding the demuxer
+ * and the per-pad queue/parse/decode chains; its "video_src"/"audio_src"
+ * ghost pads are linked to the shared sinks only while the input is active.
+ */
+typedef struct _GstPlayerSinkBinInput
+{
+	GstPlayerSinkBin* owner;
+	GstElement* bin;
+	GstElement* timeshift; /* ring buffer in front of typefind, main input only */
+	GstElement* typefind;
+	GstElement* demux; /* NULL for elementary stream input */
+	GstElement* m_vqueue;
+	GstElement* video_parser;
+	GstElement* video_decoder; /* only when the sink takes raw video */
+	GstElement* video_deinterlace; /* behind the decoder while the video is interlaced */
+	gchar deinterlace_method[16];
+	GstElement* m_aqueue;
+	GstElement* m_audio_parser;
+	GstElement* m_adec;
+	GstPad* video_src;
+	GstPad* audio_src;
+	gboolean audio_linked;
+	gboolean video_gate_open;
+	gboolean audio_gate_open;
+
+	/* Stream changes at segment boundaries: a chain whose demuxer pad went
+	 * away is either relinked to the replacement pad or drained and replaced
+	 * by a new chain behind the same ghost pad. Orphaned, retired, pending and
+	 * waiting are under the object lock */
+	gboolean upstream_eos;
+	GstCaps* video_caps;
+	GstCaps* audio_caps;
+	gboolean video_orphaned;
+	gboolean audio_orphaned;
+	GList* video_retired;
+	GList* audio_retired;
+	GstPad* video_pending; /* src pad of the replacement chain, blocked */
+	GstPad* audio_pending;
+	gulong video_pending_probe;
+	gulong video_slot_probe;  /* pending switch of decode path */
+	gulong audio_pending_probe;
+	GstPad* video_waiting; /* new demuxer pad that came before the old one ended */
+	GstPad* audio_waiting;
+	gulong video_waiting_probe;
+	gulong audio_waiting_probe;
+
+	/* Audio description chain, mixed into the main audio, see "ad-pid" */
+	GstElement* ad_queue;
+	GstElement* ad_parser;
+	GstElement* ad_decoder;
+	GstElement* ad_convert;
+	GstElement* ad_pan;
+	GstPad* ad_src;
+	gulong ad_scan_probe;
+	GstPlayerSinkBinAdControl ad_controls[PLAYERSINKBIN_AD_CONTROL_SLOTS];
+	guint ad_first;
+	guint ad_count;
+	guint64 ad_descriptors;
+	guint8 ad_fade; /* in effect */
+	guint8 ad_pan_byte;
+	GstClockTime ad_last_buffer; /* arrival of the last decoded AD buffer */
+	gboolean ad_detaching;
+
+	/* Codec changes on the same demuxer pad, handled in the video queue thread */
+	gboolean video_reconfiguring;
+	guint codec_changes;
+	GstClockTime last_codec_change_latency;
+
+	/* Video buffers since the last keyframe, kept while in standby */
+	GList* gop_cache;
+	guint gop_cache_bytes;
+
+	/* Ingest statistics */
+	guint64 in_buffers;
+	guint64 in_bytes;
+	guint64 in_pulls; /* getrange calls when upstream runs in pull mode */
+	guint64 demux_time;
+	guint64 in_offset; /* byte offset of the data the demuxer is working on */
+	guint64 timeshift_bytes; /* written into the time-shift buffer */
+	guint64 timeshift_time;
+
+	/* Demuxed video buffers waiting for the parser to flag keyframes */
+	GstClockTime index_pts[PLAYERSINKBIN_INDEX_PENDING_SLOTS];
+	guint64 index_offset[PLAYERSINKBIN_INDEX_PENDING_SLOTS];
+	guint index_slot;
+
+	/* Ingest batching, see the "ingest-chunk-size" property. Input is copied
+	 * into pooled chunks which are pushed to the demuxer when full or late. */
+	GstBufferPool* ingest_pool;
+	guint ingest_pool_size;
+	GstBuffer* ingest_chunk;
+	gsize ingest_fill;
+	GstClockTime ingest_first; /* arrival of the chunk's first data, under the object lock */
+	gboolean ingest_flush_scheduled;
+	GstFlowReturn ingest_ret; /* of a push from the tick, returned with the next buffer */
+	guint64 ingest_chunks;
+
+	/* Software video decode timing, keyed by PTS between decoder sink and src */
+	GstClockTime decode_pts[PLAYERSINKBIN_DECODE_TIMING_SLOTS];
+	GstClockTime decode_start[PLAYERSINKBIN_DECODE_TIMING_SLOTS];
+	guint decode_slot;
+	guint64 decoded_frames;
+	guint64 decode_time;
+	guint64 decode_time_max;
+	gint decoder_threads;
+	gint lowres;        /* reduced-resolution decode, 1/2^lowres size */
+
+	GstPlayerSinkBinTsHealth ts_health;
+
+	/* SCTE-35 cues, see "scte35-cues" */
+	GstClockTime in_arrival; /* when the data the demuxer is working on came in */
+	guint32 scte35_seqnum;   /* of the last cue, tsdemux sends it on every pad */
+} GstPlayerSinkBinInput;
+
+/* Mosaic: programs of the main input's multiplex shown side by side, see the
+ * "mosaic-programs" property */
+#define PLAYERSINKBIN_MAX_TILES 9
+
+typedef struct _GstPlayerSinkBinTile
+{
+	GstPlayerSinkBin* owner;
+	gint program;
+	gchar rectangle[32];  /* "x,y,w,h" of the tile on screen */
+	GstPad* parse_pad;    /* program pad requested from the TS parser */
+	GstElement* demux;    /* PES only, the parser already split the PIDs */
+	GstElement* queue;
+	GstElement* parser;
+	GstElement* decoder;  /* only when the sink takes raw video */
+	GstElement* convert;
+	GstElement* scale;    /* only when the sink cannot scale */
+	GstElement* filter;
+	GstElement* sink;
+	gboolean plugged;
+
+	/* CPU time of the tile's queue thread, which runs parse, decode and render */
+	gpointer cpu_thread;
+	gint64 cpu_last;
+	guint64 cpu_time;
+	guint64 buffers;
+} GstPlayerSinkBinTile;
 
 struct _GstPlayerSinkBin
 {
@@ -73,7 +382,9 @@ struct _GstPlayerSinkBin
 	GstElement* m_adec;
 	GstElement* m_audio_parser;
 	GstElement* m_resample;
+	GstElement* m_scaletempo; /* between m_aconvert and m_resample once needed */
 	GstElement* vconvert;
+	GstElement* vrate;
 	GstElement* m_vscalar;
         GstElement* m_vfilter;
 	GstCaps* m_vcaps;
@@ -87,8 +398,20 @@ struct _GstPlayerSinkBin
 	gboolean video_mute; /* ReadWriteable */
 	gboolean show_last_frame; /* ReadWriteable */
 	char video_rectangle[16];/* ReadWriteable */
+	guint rect_width;  /* size of video_rectangle, 0 for full screen */
+	guint rect_height;
 	gint plane;/* ReadWriteable */
+	gboolean low_power; /* ReadWriteable, for chains plugged afterwards */
+	gchar* deinterlace_method; /* ReadWriteable, NULL chooses by CPU budget */
+	gint resource_priority; /* ReadWriteable */
+	guint resource_state;   /* decoder slot, under the process resource lock */
+	guint resource_preemptions;
+	gboolean video_degraded; /* decoding in software for lack of a slot */
+	guint low_power_framerate; /* ReadWriteable */
 	gfloat play_speed; /* ReadWriteable */
+	gfloat stretch_min_speed; /* ReadWriteable, speeds keeping time-stretched audio */
+	gfloat stretch_max_speed; /* ReadWriteable */
+	guint audio_teardowns;
 	gdouble current_position; /* ReadWriteable */
 	gint resolution;/* ReadWriteable */
 	gboolean audio_mute; /* ReadWriteable */
@@ -103,8 +426,97 @@ struct _GstPlayerSinkBin
 	guint preffered_audio_pid;
 	gchar prefferd_pid_instring[8];
 	gchar linkedaudiopadname[16];
+	guint ad_pid; /* ReadWriteable, audio description PID mixed in, 0 for none */
+	gboolean scte35_cues; /* ReadWriteable */
+	guint ts_health_interval; /* ReadWriteable, ms between health messages, 0 for none */
+	GstClockID ts_health_id;  /* PAT timeout and intervals without data */
+	GThread* ts_health_thread; /* running its callback */
+	GstClockID ingest_tick_id; /* pushes ingest chunks held past "ingest-latency" */
+	GThread* ingest_tick_thread;
+	GstClockTime ingest_tick_period;
+	guint64 scte35_count;
+	GstClockTimeDiff scte35_lead_time;     /* splice point minus delivery, of the last cue */
+	GstClockTimeDiff scte35_lead_time_min;
+	GstClockTime scte35_latency;           /* input arrival to delivery, of the last cue */
+	GstClockTime scte35_latency_max;
+	GstElement* ad_mixer; /* in front of m_aconvert while ad_pid is set */
+	GstPad* ad_main_pad;  /* mixer pad of the main audio */
+	GstClockID ad_stall_id;
+	GThread* ad_stall_thread;
 
 	gboolean m_bUseIsmdDemux;
+
+	/* Demux front-ends, see GstPlayerSinkBinInput. The demux/parser/decoder
+	 * members above always alias the elements of the active input. */
+	GstPlayerSinkBinInput inputs[PLAYERSINKBIN_MAX_INPUTS];
+	guint active_input;
+	GstPad* standby_pad;
+	GstClockTime swap_start;
+	GstClockTime last_swap_latency;
+	gboolean is_live; /* Writeable, recorded content may be pulled */
+	GstClockTime seek_start;
+	GstClockTime last_seek_latency;
+	guint ingest_chunk_size; /* ReadWriteable */
+	guint64 ingest_latency; /* ReadWriteable */
+
+	/* Streaming thread scheduling, applied on stream-status ENTER */
+	gchar* thread_sched[PLAYERSINKBIN_THREAD_MAX]; /* ReadWriteable */
+	GstPlayerSinkBinThreadConfig thread_config[PLAYERSINKBIN_THREAD_MAX];
+	gboolean thread_sched_set[PLAYERSINKBIN_THREAD_MAX]; /* set as property, media.conf no longer applies */
+	gint video_decoder_threads; /* ReadWriteable */
+	gboolean video_decoder_threads_set;
+
+	/* media.conf in effect, refreshed on READY to PAUSED, swapped under the
+	 * object lock */
+	GstPlayerSinkBinMediaConf* conf;
+
+	/* Queued "event-callback" emissions, dispatched from event_context */
+	gboolean async_events; /* ReadWriteable */
+	GMainContext* event_context; /* ReadWriteable, NULL runs a dispatch thread */
+	GMainLoop* event_loop;
+	GThread* event_thread;
+	GSource* event_source;
+	GQueue event_queue;
+	guint64 events_posted;
+	guint64 events_coalesced;
+	GstClockTime event_delay_last;
+	GstClockTime event_delay_max;
+
+	guint snapshot_id;
+	GList* snapshot_pending; /* requests waiting for the next decoded picture */
+
+	/* Stall watchdog, running while PLAYING */
+	guint64 watchdog_timeout; /* ReadWriteable */
+	GstClockID watchdog_id;
+	GThread* watchdog_thread;
+	GCond tick_cond;  /* with the object lock, a periodic callback returned */
+	GstPlayerSinkBinWatch video_watch;
+	GstPlayerSinkBinWatch audio_watch;
+
+	/* Time-shift buffer of the main input, applied on READY to PAUSED */
+	guint64 timeshift_duration; /* ReadWriteable */
+	guint timeshift_bitrate; /* ReadWriteable */
+	gchar* timeshift_location; /* ReadWriteable, NULL keeps the buffer in RAM */
+
+	/* Mosaic tiles of the main input, set up when its type is found */
+	gchar* mosaic_programs; /* ReadWriteable */
+	GstPlayerSinkBinTile tiles[PLAYERSINKBIN_MAX_TILES];
+	guint n_tiles;
+
+	/* SUBTEC subtitle ring */
+	gchar* subtitle_ring_name; /* ReadWriteable, NULL writes to the subtecsink file */
+	guint subtitle_ring_size;  /* ReadWriteable */
+	GstPlayerSinkBinSubtitleRing* subtitle_ring;
+	gsize subtitle_ring_map_size;
+	GstSegment subtitle_segment;
+	gboolean subtitle_discont;
+	guint64 subtitle_records;
+
+	/* Keyframe index of the main input, sorted by time */
+	GArray* keyframe_index;
+	gchar* keyframe_index_location; /* ReadWriteable */
+	gboolean keyframe_index_dirty;
+	GstSegment keyframe_index_segment;
 };
 
 struct _GstPlayerSinkBinClass
@@ -112,6 +524,11 @@ struct _GstPlayerSinkBinClass
 	GstBinClass parent_class;
 	void (*playersinkbinstatuscb)( GstPlayerSinkBin* gstplayersinkbinsrc, gint status, gpointer userdata);
 	void (*videonativesizecb)(gint* width, gint* height);  
+
+	/* Actions */
+	gboolean (*swap_standby)(GstPlayerSinkBin* playersinkbin);
+	gint64 (*get_keyframe_offset)(GstPlayerSinkBin* playersinkbin, guint64 position, gboolean forward);
+	guint (*snapshot)(GstPlayerSinkBin* playersinkbin, guint width, guint height);
 };
 
 GType gst_player_sinkbin_get_type (void);